@@ -0,0 +1,395 @@
+//===================================================================================
+//
+//  Copyright (C) 2017 Alex Lotz, Dennis Stampfer, Matthias Lutz, Christian Schlegel
+//
+//        lotz@hs-ulm.de
+//        stampfer@hs-ulm.de
+//        lutz@hs-ulm.de
+//        schlegel@hs-ulm.de
+//
+//        Servicerobotik Ulm
+//        Christian Schlegel
+//        Ulm University of Applied Sciences
+//        Prittwitzstr. 10
+//        89075 Ulm
+//        Germany
+//
+//  This file is part of the SmartSoft Component-Developer C++ API.
+//
+//  Redistribution and use in source and binary forms, with or without modification,
+//  are permitted provided that the following conditions are met:
+//
+//  1. Redistributions of source code must retain the above copyright notice,
+//     this list of conditions and the following disclaimer.
+//
+//  2. Redistributions in binary form must reproduce the above copyright notice,
+//     this list of conditions and the following disclaimer in the documentation
+//     and/or other materials provided with the distribution.
+//
+//  3. Neither the name of the copyright holder nor the names of its contributors
+//     may be used to endorse or promote products derived from this software
+//     without specific prior written permission.
+//
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+//  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+//  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+//  IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+//  INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+//  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+//  DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+//  LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE
+//  OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+//  OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+//===================================================================================
+
+#ifndef SMARTSOFT_INTERFACES_SMARTEPOLLTIMERMANAGER_H_
+#define SMARTSOFT_INTERFACES_SMARTEPOLLTIMERMANAGER_H_
+
+#if defined(__linux__)
+
+#include <map>
+#include <cstdint>
+
+// C++11 includes
+#include <chrono>
+#include <mutex>
+#include <thread>
+#include <condition_variable>
+
+// Linux includes
+#include <sys/epoll.h>
+#include <sys/timerfd.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+#include <cerrno>
+
+#include "smartStatusCode.h"
+#include "smartTimerManagerBase.h"
+
+namespace Smart {
+
+/** Handler interface for file descriptors that are monitored by an EpollTimerManager
+ *
+ *  This allows to multiplex the timer expiries with arbitrary other file descriptors
+ *  (e.g. sockets or eventfds) within a single event-loop thread.
+ */
+class IFileDescriptorHandler {
+public:
+	IFileDescriptorHandler() { }
+	virtual ~IFileDescriptorHandler() { }
+
+	/** Called from within the event loop each time the file descriptor becomes ready
+	 *
+	 *  @param fd the ready file descriptor
+	 *  @param events the ready events (EPOLLIN, EPOLLOUT, EPOLLERR, ...)
+	 */
+	virtual void handleFileDescriptor(const int &fd, const std::uint32_t &events) = 0;
+};
+
+/** Linux-specific ITimerManager based on timerfd and epoll
+ *
+ *  A single timerfd (CLOCK_MONOTONIC, absolute time) is armed to the next expiry of the
+ *  internal TimingWheel, so expiries are driven by the kernel's high-resolution timers instead
+ *  of a condition-variable wait. The event loop is executed by run() within the calling thread
+ *  (e.g. the component's main thread) or within an internal thread (see start()). Additional
+ *  file descriptors can be registered with addFileDescriptor() and are handled by the same loop.
+ *
+ *  See TimerManagerBase for the timer upcall semantics.
+ */
+class EpollTimerManager : public TimerManagerBase {
+private:
+	int epoll_fd;
+	int timer_fd;
+	int wakeup_fd;
+	// the errno of the failed initialization (0 if the manager is valid)
+	int last_error;
+	bool stopped;
+	// set while run() executes the event loop (within the calling or the internal thread)
+	bool running;
+	// the absolute time the timerfd is currently armed for (max() if disarmed)
+	TimingWheel::TimePoint armed_time;
+	std::map<int, IFileDescriptorHandler*> fd_handlers;
+	// the file descriptor whose handler is currently called (-1 if none)
+	int dispatching_fd;
+	// signals the end of a handler call and the return from run()
+	std::condition_variable fd_cond_var;
+	std::thread::id loop_thread_id;
+	std::thread loop_thread;
+
+	void arm(const TimingWheel::TimePoint &deadline) {
+		itimerspec spec;
+		spec.it_interval.tv_sec = 0;
+		spec.it_interval.tv_nsec = 0;
+		if(deadline == TimingWheel::TimePoint::max()) {
+			// disarm
+			spec.it_value.tv_sec = 0;
+			spec.it_value.tv_nsec = 0;
+		} else {
+			// the steady_clock is based on CLOCK_MONOTONIC on Linux
+			std::chrono::nanoseconds ns = std::chrono::duration_cast<std::chrono::nanoseconds>(deadline.time_since_epoch());
+			if(ns <= std::chrono::nanoseconds::zero()) ns = std::chrono::nanoseconds(1);
+			spec.it_value.tv_sec = static_cast<time_t>(ns.count() / 1000000000L);
+			spec.it_value.tv_nsec = static_cast<long>(ns.count() % 1000000000L);
+		}
+		if(timerfd_settime(timer_fd, TFD_TIMER_ABSTIME, &spec, 0) != 0) last_error = errno;
+		armed_time = deadline;
+	}
+
+	// executes the event loop (running must have been set with the timer_mutex locked)
+	int run_loop(std::unique_lock<std::mutex> &lock) {
+		const int MAX_EVENTS = 16;
+		epoll_event events[MAX_EVENTS];
+		unsigned long applied_generation = 0;
+		int result = 0;
+
+		loop_thread_id = std::this_thread::get_id();
+		while(!stopped) {
+			this->apply_dispatch_parameters(applied_generation);
+			lock.unlock();
+			int count = epoll_wait(epoll_fd, events, MAX_EVENTS, -1);
+			lock.lock();
+			if(count < 0) {
+				if(errno == EINTR) continue;
+				result = -1;
+				break;
+			}
+			for(int i=0; i<count && !stopped; ++i) {
+				const int fd = events[i].data.fd;
+				if(fd == timer_fd) {
+					this->drain(timer_fd);
+					armed_time = TimingWheel::TimePoint::max();
+					this->dispatch_expired(lock);
+					TimingWheel::TimePoint next;
+					this->arm(wheel.nextExpiry(next)? next : TimingWheel::TimePoint::max());
+				} else if(fd == wakeup_fd) {
+					this->drain(wakeup_fd);
+				} else {
+					auto it = fd_handlers.find(fd);
+					if(it == fd_handlers.end()) continue;
+					IFileDescriptorHandler *handler = it->second;
+					dispatching_fd = fd;
+					lock.unlock();
+					handler->handleFileDescriptor(fd, events[i].events);
+					lock.lock();
+					dispatching_fd = -1;
+					fd_cond_var.notify_all();
+				}
+			}
+		}
+		loop_thread_id = std::thread::id();
+		running = false;
+		fd_cond_var.notify_all();
+		return result;
+	}
+
+	inline void close_fds() {
+		if(wakeup_fd >= 0) close(wakeup_fd);
+		if(timer_fd >= 0) close(timer_fd);
+		if(epoll_fd >= 0) close(epoll_fd);
+		wakeup_fd = -1;
+		timer_fd = -1;
+		epoll_fd = -1;
+	}
+
+	// creates the internal file descriptors (returns false and closes the already opened ones on failure)
+	bool init_fds() {
+		epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+		if(epoll_fd < 0) return false;
+		timer_fd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+		if(timer_fd < 0) return false;
+		wakeup_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+		if(wakeup_fd < 0) return false;
+
+		epoll_event ev;
+		ev.events = EPOLLIN;
+		ev.data.fd = timer_fd;
+		if(epoll_ctl(epoll_fd, EPOLL_CTL_ADD, timer_fd, &ev) != 0) return false;
+		ev.data.fd = wakeup_fd;
+		if(epoll_ctl(epoll_fd, EPOLL_CTL_ADD, wakeup_fd, &ev) != 0) return false;
+		return true;
+	}
+
+	inline void wakeup() {
+		std::uint64_t one = 1;
+		ssize_t result = write(wakeup_fd, &one, sizeof(one));
+		(void)result;
+	}
+
+	inline void drain(const int &fd) {
+		std::uint64_t value = 0;
+		ssize_t result = read(fd, &value, sizeof(value));
+		(void)result;
+	}
+
+protected:
+	virtual void notify_dispatcher(const TimingWheel::TimePoint &deadline) {
+		if(deadline == TimingWheel::TimePoint::min()) {
+			// e.g. changed dispatch parameters
+			this->wakeup();
+		} else {
+			// arm for the tick at which the wheel actually expires the timer (instead of waking up too early)
+			const TimingWheel::TimePoint tick_time = wheel.tickTime(deadline);
+			// timerfd_settime is thread-safe, so the loop needs not to be woken up
+			if(tick_time < armed_time) this->arm(tick_time);
+		}
+	}
+
+public:
+	/** Default constructor
+	 *
+	 *  The event loop is not started automatically, call either run() or start().
+	 *  If the internal file descriptors can not be created (e.g. on fd exhaustion or
+	 *  within a seccomp sandbox), the manager is invalid: isValid() returns false,
+	 *  getLastError() returns the errno, and scheduleTimer(), run() and start() fail.
+	 *
+	 *  @param resolution the tick resolution of the internal TimingWheel
+	 */
+	EpollTimerManager(const std::chrono::steady_clock::duration &resolution=std::chrono::microseconds(100))
+	:	TimerManagerBase(resolution)
+	,	epoll_fd(-1)
+	,	timer_fd(-1)
+	,	wakeup_fd(-1)
+	,	last_error(0)
+	,	stopped(false)
+	,	running(false)
+	,	armed_time(TimingWheel::TimePoint::max())
+	,	dispatching_fd(-1)
+	{
+		if(!this->init_fds()) {
+			last_error = errno;
+			this->close_fds();
+		}
+	}
+
+	/** Default destructor
+	 *
+	 *  Stops the event loop, joins the internal thread (if started) and waits until run()
+	 *  returned in any other thread, before all internal file descriptors are closed.
+	 */
+	virtual ~EpollTimerManager()
+	{
+		this->stop();
+		if(loop_thread.joinable()) loop_thread.join();
+		{
+			std::unique_lock<std::mutex> lock(timer_mutex);
+			// the event loop can not be waited for from within one of its own handlers
+			while(running && loop_thread_id != std::this_thread::get_id()) fd_cond_var.wait(lock);
+		}
+		this->close_fds();
+	}
+
+	/// returns false if the internal file descriptors could not be created
+	inline bool isValid() const {
+		return epoll_fd >= 0;
+	}
+
+	/** Returns the errno of the last failed system call
+	 *
+	 *  This is the reason why the manager is invalid (see isValid()) or, for a valid
+	 *  manager, the error of the last failed attempt to arm the timerfd (0 if none).
+	 */
+	inline int getLastError() const {
+		return last_error;
+	}
+
+	/// fails (returns -1) if the manager is invalid (see isValid()), scheduleTimer() forwards to this method
+	virtual TimerId scheduleTimerWithSlack(
+			ITimerHandler *handler,
+			const std::chrono::steady_clock::duration &first_time,
+			const std::chrono::steady_clock::duration &interval,
+			const std::chrono::steady_clock::duration &slack
+		)
+	{
+		if(!this->isValid()) return -1;
+		return TimerManagerBase::scheduleTimerWithSlack(handler, first_time, interval, slack);
+	}
+
+	/** Registers an additional file descriptor in the event loop
+	 *
+	 *  @param fd the file descriptor to monitor
+	 *  @param events the epoll events to wait for (e.g. EPOLLIN)
+	 *  @param handler the handler that is called from within the event loop
+	 *
+	 *  @return status code
+	 *    - SMART_OK    : the file descriptor is monitored
+	 *    - SMART_ERROR : epoll_ctl failed (e.g. fd already registered)
+	 */
+	StatusCode addFileDescriptor(const int &fd, const std::uint32_t &events, IFileDescriptorHandler *handler) {
+		std::unique_lock<std::mutex> lock(timer_mutex);
+		epoll_event ev;
+		ev.events = events;
+		ev.data.fd = fd;
+		if(handler == 0 || epoll_ctl(epoll_fd, EPOLL_CTL_ADD, fd, &ev) != 0) return SMART_ERROR;
+		fd_handlers[fd] = handler;
+		return SMART_OK;
+	}
+
+	/** Removes a file descriptor from the event loop
+	 *
+	 *  If the handler of this file descriptor is currently executed by another thread,
+	 *  this call blocks until the handler returns.
+	 *
+	 *  @param fd the file descriptor to remove
+	 *
+	 *  @return status code
+	 *    - SMART_OK      : the file descriptor is not monitored anymore
+	 *    - SMART_WRONGID : the file descriptor was not registered
+	 */
+	StatusCode removeFileDescriptor(const int &fd) {
+		std::unique_lock<std::mutex> lock(timer_mutex);
+		auto it = fd_handlers.find(fd);
+		if(it == fd_handlers.end()) return SMART_WRONGID;
+		epoll_ctl(epoll_fd, EPOLL_CTL_DEL, fd, 0);
+		fd_handlers.erase(it);
+		if(std::this_thread::get_id() != loop_thread_id) {
+			while(dispatching_fd == fd) fd_cond_var.wait(lock);
+		}
+		return SMART_OK;
+	}
+
+	/** Runs the event loop within the calling thread until stop() is called
+	 *
+	 *  There can only be one event loop at a time, i.e. run() fails while another thread
+	 *  executes run() or the internal thread has been started (see start()).
+	 *
+	 *  @return 0 on regular stop or -1 on failure (e.g. for an invalid manager or if the loop is already running)
+	 */
+	int run() {
+		if(!this->isValid()) return -1;
+		std::unique_lock<std::mutex> lock(timer_mutex);
+		if(running) return -1;
+		running = true;
+		return this->run_loop(lock);
+	}
+
+	/** Starts the event loop within an internal thread
+	 *
+	 *  @return 0 on success (and if the thread has already been started) or -1 on failure
+	 *          (e.g. if another thread executes run())
+	 */
+	int start() {
+		std::unique_lock<std::mutex> lock(timer_mutex);
+		if(loop_thread.joinable()) return 0;
+		if(stopped || running || !this->isValid()) return -1;
+		running = true;
+		loop_thread = std::thread([this]() {
+			std::unique_lock<std::mutex> loop_lock(timer_mutex);
+			this->run_loop(loop_lock);
+		});
+		return 0;
+	}
+
+	/// signals the event loop to return from run() (the manager can not be restarted afterwards)
+	void stop() {
+		std::unique_lock<std::mutex> lock(timer_mutex);
+		stopped = true;
+		this->wakeup();
+	}
+};
+
+} /* namespace Smart */
+
+#endif /* defined(__linux__) */
+
+#endif /* SMARTSOFT_INTERFACES_SMARTEPOLLTIMERMANAGER_H_ */
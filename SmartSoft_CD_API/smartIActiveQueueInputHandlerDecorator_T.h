@@ -173,14 +173,16 @@ public:
 	 *
 	 * @param component The component pointer used to properly initialize the internally used ITask
 	 * @param inner_handler The IInputHandler that is being decorated by an active FIFO queue
+	 * @param parameters The (optional) scheduling parameters of the internal thread
 	 *
 	 */
-	IActiveQueueInputHandlerDecorator(IComponent *component, IInputHandler<InputType> *inner_handler)
+	IActiveQueueInputHandlerDecorator(IComponent *component, IInputHandler<InputType> *inner_handler, const TaskSchedulingParameters &parameters=TaskSchedulingParameters())
 	:	IInputHandler<InputType>(inner_handler->subject)
 	,	ITask(component)
 	,	inner_handler(inner_handler)
 	,	cancelled(false)
 	{
+		this->scheduling_parameters = parameters;
 		// detach the inner-handler as its handle method will be called by this decorator
 		this->inner_handler->detach_self();
 	}
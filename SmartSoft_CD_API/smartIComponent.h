@@ -48,10 +48,16 @@
 
 #include <string>
 
+// C++11 includes
+#include <memory>
+#include <mutex>
+
 // SmartSoft includes
 #include "smartStatusCode.h"
 #include "smartIShutdownObserver.h"
 #include "smartITimerManager.h"
+#include "smartTaskSchedulingParameters.h"
+#include "smartThreadPoolExecutor.h"
 
 namespace Smart {
 
@@ -69,6 +75,10 @@ namespace Smart {
  *
  */
 class IComponent : public ShutdownSubject {
+private:
+	std::mutex executor_mutex;
+	std::unique_ptr<ThreadPoolExecutor> default_executor;
+
 protected:
 	/// the internal blocking flag
 	bool is_blocking;
@@ -139,6 +149,40 @@ public:
 	 *  @return a pointer to the ITimerManager
 	 */
 	virtual ITimerManager* getTimerManager() = 0;
+
+	/** get the executor for asynchronous completions (e.g. of IQueryClientPattern::queryAsync())
+	 *
+	 *  The default implementation lazily creates a single-threaded ThreadPoolExecutor that is
+	 *  owned by this component, i.e. all completions of a component are serialized. Derived
+	 *  classes can override this method to provide a middleware-specific executor (e.g. the
+	 *  middleware's event loop).
+	 *
+	 *  @return a pointer to the IExecutor
+	 */
+	virtual IExecutor* getExecutor() {
+		std::unique_lock<std::mutex> lock(executor_mutex);
+		if(!default_executor) {
+			default_executor.reset(new ThreadPoolExecutor());
+		}
+		return default_executor.get();
+	}
+
+	/** Locks the component's memory into RAM and prefaults the stack
+	 *
+	 *  This method is optional and should be called in the main()-routine of a component
+	 *  before any of the user tasks are started. Afterwards, no page-faults should occur
+	 *  within time-critical code. The default implementation uses lockProcessMemory().
+	 *
+	 *  @param params the memory-locking parameters
+	 *
+	 *  @return status code
+	 *    - SMART_OK         : memory is locked
+	 *    - SMART_NOTALLOWED : missing privileges or not supported on this platform
+	 *    - SMART_ERROR      : something went wrong
+	 */
+	virtual StatusCode lockMemory(const MemoryLockingParameters &params=MemoryLockingParameters()) {
+		return lockProcessMemory(params);
+	}
 };
 
 } /* namespace Smart */
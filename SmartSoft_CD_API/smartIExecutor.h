@@ -0,0 +1,83 @@
+//===================================================================================
+//
+//  Copyright (C) 2017 Alex Lotz, Dennis Stampfer, Matthias Lutz, Christian Schlegel
+//
+//        lotz@hs-ulm.de
+//        stampfer@hs-ulm.de
+//        lutz@hs-ulm.de
+//        schlegel@hs-ulm.de
+//
+//        Servicerobotik Ulm
+//        Christian Schlegel
+//        Ulm University of Applied Sciences
+//        Prittwitzstr. 10
+//        89075 Ulm
+//        Germany
+//
+//  This file is part of the SmartSoft Component-Developer C++ API.
+//
+//  Redistribution and use in source and binary forms, with or without modification,
+//  are permitted provided that the following conditions are met:
+//
+//  1. Redistributions of source code must retain the above copyright notice,
+//     this list of conditions and the following disclaimer.
+//
+//  2. Redistributions in binary form must reproduce the above copyright notice,
+//     this list of conditions and the following disclaimer in the documentation
+//     and/or other materials provided with the distribution.
+//
+//  3. Neither the name of the copyright holder nor the names of its contributors
+//     may be used to endorse or promote products derived from this software
+//     without specific prior written permission.
+//
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+//  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+//  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+//  IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+//  INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+//  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+//  DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+//  LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE
+//  OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+//  OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+//===================================================================================
+
+#ifndef SMARTSOFT_INTERFACES_SMARTIEXECUTOR_H_
+#define SMARTSOFT_INTERFACES_SMARTIEXECUTOR_H_
+
+// C++11 includes
+#include <functional>
+
+#include "smartStatusCode.h"
+
+namespace Smart {
+
+/** Interface for executing short jobs (e.g. completion callbacks) in the context of a component
+ *
+ *  An IExecutor decouples the thread that detects an event (e.g. the arrival of a query answer)
+ *  from the thread that processes it. Jobs are executed asynchronously and must neither block
+ *  for a long time nor throw exceptions.
+ */
+class IExecutor {
+public:
+	/** Default destructor
+	 */
+	virtual ~IExecutor()
+	{  }
+
+	/** Queues the given job for asynchronous execution
+	 *
+	 *  @param job the job to be executed
+	 *
+	 *  @return status code
+	 *    - SMART_OK        : the job has been queued and will be executed
+	 *    - SMART_CANCELLED : the executor has been stopped and the job is rejected
+	 *    - SMART_ERROR     : something went wrong, the job is rejected
+	 */
+	virtual StatusCode post(const std::function<void()> &job) = 0;
+};
+
+} /* namespace Smart */
+
+#endif /* SMARTSOFT_INTERFACES_SMARTIEXECUTOR_H_ */
@@ -50,6 +50,7 @@
 #include "smartITaskInteractionObserver.h"
 
 #include "smartTaskTriggerObserver.h"
+#include "smartTaskExecutionBudget.h"
 
 
 namespace Smart {
@@ -59,6 +60,54 @@ class IManagedTask
 ,	public TaskTriggerObserver
 //,	public TaskInteractionSubject
 {
+private:
+	// the CPU-time budget (monitoring is disabled for a zero budget)
+	TaskExecutionBudget execution_budget;
+	// the trigger's prescale factor before the first degradation step
+	unsigned int original_prescale;
+	// the currently applied degradation steps
+	unsigned int degradation_level;
+	// remaining trigger cycles to skip (TASK_OVERLOAD_SKIP_CYCLES)
+	unsigned int skip_cycles;
+	// consecutive cycles within the budget (used for recovery)
+	unsigned int cycles_within_budget;
+	// total number of budget overruns
+	unsigned long overrun_count;
+
+	void degrade(const std::chrono::nanoseconds &used_time) {
+		switch(execution_budget.policy) {
+		case TASK_OVERLOAD_RAISE_PRESCALE: {
+			unsigned int prescale = this->getPrescaleFactor();
+			if(prescale == 0) break;
+			if(degradation_level == 0) original_prescale = prescale;
+			if(2*prescale <= execution_budget.maxPrescaleFactor) {
+				this->setPrescaleFactor(2*prescale);
+				degradation_level++;
+			}
+			break;
+		}
+		case TASK_OVERLOAD_SKIP_CYCLES:
+			// skip one cycle for each started budget that the overrun consumed
+			skip_cycles = static_cast<unsigned int>((used_time.count()-1) / execution_budget.budget.count());
+			break;
+		case TASK_OVERLOAD_DEGRADED_EXECUTE:
+			degradation_level = 1;
+			break;
+		default:
+			break;
+		}
+	}
+
+	void recover() {
+		if(degradation_level == 0 || ++cycles_within_budget < execution_budget.recoveryCycles) return;
+		cycles_within_budget = 0;
+		degradation_level--;
+		if(execution_budget.policy == TASK_OVERLOAD_RAISE_PRESCALE) {
+			unsigned int prescale = this->getPrescaleFactor();
+			this->setPrescaleFactor((degradation_level==0 || prescale/2 < original_prescale)? original_prescale : prescale/2);
+		}
+	}
+
 protected:
 	virtual void on_shutdown() {
 		this->stop(false);
@@ -88,7 +137,52 @@ protected:
 
 	/// indirection of the execution method, can be overloaded in derived classes to extend default behavior
 	virtual int execute_protected_region() {
-		// default implementation delegates to on_execute
+		if(execution_budget.budget == std::chrono::nanoseconds::zero()) {
+			// default implementation delegates to on_execute
+			return this->on_execute();
+		}
+
+		if(skip_cycles > 0) {
+			// shed this cycle to contain a previous overrun
+			skip_cycles--;
+			return 0;
+		}
+
+		bool degraded = (execution_budget.policy == TASK_OVERLOAD_DEGRADED_EXECUTE && degradation_level > 0);
+		std::chrono::nanoseconds start_time, end_time;
+		const bool measured = getThreadCpuTime(start_time);
+		int result = (degraded)? this->on_execute_degraded() : this->on_execute();
+		if(measured == false || getThreadCpuTime(end_time) == false) {
+			// the cycle is not accounted (and does not count as within the budget)
+			return result;
+		}
+		std::chrono::nanoseconds used_time = end_time - start_time;
+
+		if(used_time > execution_budget.budget) {
+			overrun_count++;
+			cycles_within_budget = 0;
+			this->on_budget_overrun(used_time);
+			this->degrade(used_time);
+		} else {
+			this->recover();
+		}
+		return result;
+	}
+
+	/** user hook that is called after each on_execute() cycle that overran the execution budget
+	 *
+	 *  This hook is called from within the task's thread before the degradation policy is applied.
+	 *
+	 *  @param used_time the thread CPU time consumed by the overrunning cycle
+	 */
+	virtual void on_budget_overrun(const std::chrono::nanoseconds &) {  }
+
+	/** user hook that replaces on_execute() while the task is degraded (TASK_OVERLOAD_DEGRADED_EXECUTE)
+	 *
+	 *  The default implementation calls on_execute(). Overload this method to provide
+	 *  a cheaper fallback computation.
+	 */
+	virtual int on_execute_degraded() {
 		return this->on_execute();
 	}
 public:
@@ -96,6 +190,11 @@ public:
 	:	ITask(component) // virtual base
 	,	TaskTriggerObserver(trigger)
 //	,	TaskInteractionSubject()
+	,	original_prescale(1)
+	,	degradation_level(0)
+	,	skip_cycles(0)
+	,	cycles_within_budget(0)
+	,	overrun_count(0)
 	{ }
 	virtual ~IManagedTask()
 	{ }
@@ -108,6 +207,39 @@ public:
 
 	/// user hook that is called once at the <b>end</b> of the thread
 	virtual int on_exit() = 0;
+
+	/** Sets the CPU-time budget of each task cycle
+	 *
+	 *  Must be called before the task is started (i.e. it is not synchronized with the task's thread).
+	 *
+	 *  @param budget the execution budget and the degradation policy on overruns
+	 *
+	 *  @return 0 on success or -1 if the thread CPU-time clock is not available on this
+	 *          platform (see isThreadCpuTimeSupported()), the budget monitoring stays disabled then
+	 */
+	int set_execution_budget(const TaskExecutionBudget &budget) {
+		if(budget.budget != std::chrono::nanoseconds::zero() && isThreadCpuTimeSupported() == false) {
+			this->execution_budget = TaskExecutionBudget();
+			return -1;
+		}
+		this->execution_budget = budget;
+		return 0;
+	}
+
+	/// returns the current execution budget
+	inline TaskExecutionBudget get_execution_budget() const {
+		return execution_budget;
+	}
+
+	/// returns the total number of cycles that overran the execution budget
+	inline unsigned long get_overrun_count() const {
+		return overrun_count;
+	}
+
+	/// returns true while a degradation policy is in effect
+	inline bool is_degraded() const {
+		return degradation_level > 0 || skip_cycles > 0;
+	}
 };
 
 } /* namespace Smart */
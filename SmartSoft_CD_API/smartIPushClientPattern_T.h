@@ -48,8 +48,12 @@
 
 #include "smartIClientPattern.h"
 #include "smartIInputHandler_T.h"
+#include "smartPushUpdateHistory_T.h"
+#include "smartPushDeltaCodec_T.h"
 
+#include <vector>
 #include <chrono>
+#include <mutex>
 
 namespace Smart {
 
@@ -57,12 +61,51 @@ namespace Smart {
  *  publish/subscribe service. Clients can subscribe to regularly
  *  get every n-th update. This class inherits the API from IClientPattern.
  *
+ *  Implementations can keep the latest update in a LatestValueBuffer, so that
+ *  the receive thread never waits for tasks calling getUpdate() and vice versa.
+ *
  *  Template parameters
  *    - <b>DataType</b>: Pushed value class (Communication Object)
  *
  */
 template <class DataType>
 class IPushClientPattern : public IClientPattern, public InputSubject<DataType> {
+private:
+	PushUpdateHistory<DataType> update_history;
+	std::mutex delta_mutex;
+	PushDeltaDecoder<DataType> delta_decoder;
+
+protected:
+	/** Records a received update in the update history
+	 *
+	 *  Implementations call this method for each received update with the PushUpdateInfo
+	 *  sent by the server (see IPushServerPattern::prepare_update()).
+	 */
+	void record_update(const DataType &d, const PushUpdateInfo &info) {
+		update_history.record(d, info);
+	}
+
+	/** Discards the update history and the keyframe of the delta mode
+	 *
+	 *  Implementations call this method in subscribe() with the new prescale factor.
+	 */
+	void reset_update_history(const int &prescale) {
+		update_history.reset(prescale);
+		std::unique_lock<std::mutex> lock(delta_mutex);
+		delta_decoder.reset();
+	}
+
+	/** Reconstructs a received update of the delta mode (see IPushServerPattern::setKeyframeInterval())
+	 *
+	 *  Implementations call this method in the receive path before the update is made
+	 *  available to getUpdate() and to the handlers. Frames that can not be decoded are
+	 *  dropped. See PushDeltaDecoder::decode() for the return values.
+	 */
+	StatusCode decode_update(const PushDeltaFrame<DataType> &frame, DataType &d) {
+		std::unique_lock<std::mutex> lock(delta_mutex);
+		return delta_decoder.decode(frame, d);
+	}
+
 public:
     /** Constructor (not wired with service provider and not exposed as port).
      *  connect() / disconnect() can always be used to change
@@ -176,6 +219,43 @@ public:
      *   - SMART_ERROR               : something went completely wrong and no valid data returned.
      */
     virtual  StatusCode getUpdateWait(DataType& d, const std::chrono::steady_clock::duration &timeout=std::chrono::steady_clock::duration::zero()) = 0;
+
+    /** Sets the number of received updates kept for getUpdatesSince() (0 disables the history, which is the default)
+     */
+    void setUpdateHistoryDepth(const std::size_t &depth) {
+        update_history.setDepth(depth);
+    }
+
+    /** Returns the kept updates that are newer than the given sequence number.
+     *
+     *  Each update carries the sequence number and timestamp assigned by the server (see
+     *  PushUpdateInfo), so consumers can detect dropped updates and fetch the last N updates
+     *  (see setUpdateHistoryDepth()). Subsequent calls typically pass the sequence number of
+     *  the last returned update. See PushUpdateHistory::getUpdatesSince() for details.
+     *
+     *  @param sequence the sequence number of the latest update known to the caller (0 for all kept updates)
+     *  @param updates  is set to the newer updates (with their PushUpdateInfo) in ascending order
+     *
+     *  @return status code
+     *   - SMART_OK                  : at least one newer update has been returned
+     *   - SMART_NODATA              : there is no newer update (or the history is disabled)
+     */
+    virtual StatusCode getUpdatesSince(const uint64_t &sequence, std::vector< std::pair<PushUpdateInfo,DataType> > &updates) {
+        return update_history.getUpdatesSince(sequence, updates);
+    }
+
+    /** Returns the sequence number of the latest received update (0 if there was none)
+     */
+    virtual uint64_t getLatestSequence() {
+        return update_history.getLatestSequence();
+    }
+
+    /** Returns the number of updates that have been sent by the server (taking the prescale
+     *  factor into account) but not received by this client, detected by gaps in the sequence numbers
+     */
+    virtual unsigned long getMissedUpdates() {
+        return update_history.getMissedUpdates();
+    }
 };
 
 } /* namespace Smart */
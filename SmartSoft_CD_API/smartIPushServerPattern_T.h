@@ -46,8 +46,15 @@
 #ifndef SMARTSOFT_INTERFACES_SMARTIPUSHSERVERPATTERN_T_H_
 #define SMARTSOFT_INTERFACES_SMARTIPUSHSERVERPATTERN_T_H_
 
+// C++11 includes
+#include <memory>
+#include <mutex>
+
 #include "smartStatusCode.h"
 #include "smartIServerPattern.h"
+#include "smartSharedPushUpdate_T.h"
+#include "smartPushUpdateHistory_T.h"
+#include "smartPushDeltaCodec_T.h"
 
 namespace Smart {
 
@@ -57,11 +64,47 @@ namespace Smart {
  *  subscribed clients taking into account their
  *  individual prescale factors (see IPushClientPattern).
  *
+ *  Implementations serialize each update at most once, no matter how many
+ *  subscribers are due (see SharedPushUpdate).
+ *
+ *  In the optional delta mode (see setKeyframeInterval()) large, slowly changing
+ *  updates are sent as keyframes followed by differences (see PushDeltaTraits).
+ *
  *  Template parameters
  *    - <b>DataType</b>: Pushed value class (Communication Object)
  */
 template <class DataType>
 class IPushServerPattern : public IServerPattern {
+private:
+	std::mutex sequence_mutex;
+	uint64_t update_sequence;
+	PushDeltaEncoder<DataType> delta_encoder;
+
+protected:
+	/** Assigns the meta data to the next update and encodes it for the delta mode
+	 *
+	 *  Implementations call this method once in each put(), send the returned
+	 *  PushUpdateInfo along with the update to all subscribers (see
+	 *  IPushClientPattern::getUpdatesSince()) and send the frame returned by
+	 *  get_update_frame() to each subscriber that is due. The sequence number is
+	 *  assigned and the update is encoded atomically, so concurrent put() calls
+	 *  are encoded in the order of their sequence numbers.
+	 */
+	PushUpdateInfo prepare_update(const std::shared_ptr<const DataType> &d) {
+		std::unique_lock<std::mutex> lock(sequence_mutex);
+		PushUpdateInfo info(++update_sequence, std::chrono::system_clock::now());
+		delta_encoder.encode(d, info.sequence);
+		return info;
+	}
+
+	/** Returns the frame of the latest update for a subscriber (see PushDeltaEncoder::getFrame())
+	 *
+	 *  @param subscriberKeyframe the latest keyframe sent to the subscriber (0 for new subscribers)
+	 */
+	std::shared_ptr<const PushDeltaFrame<DataType> > get_update_frame(uint64_t &subscriberKeyframe) {
+		return delta_encoder.getFrame(subscriberKeyframe);
+	}
+
 public:
     /** Default Constructor.
      *
@@ -74,6 +117,7 @@ public:
      */
 	IPushServerPattern(IComponent* component, const std::string& serviceName)
 	:	IServerPattern(component, serviceName)
+	,	update_sequence(0)
 	{  }
 
     /** Destructor.
@@ -107,6 +151,54 @@ public:
      *                                  updated correctly.
      */
     virtual StatusCode put(const DataType& d) = 0;
+
+    /** Provide new data without copying it (see put() above).
+     *
+     *  The data is shared (not copied) with the server, which keeps it as long as it
+     *  is needed by the send paths of the subscribed clients. Thus large updates (e.g.
+     *  images or point clouds) are neither copied nor serialized per subscriber.
+     *
+     *  The default implementation calls put(const DataType&); middleware implementations
+     *  should override it (and make both overloads visible in the derived class by
+     *  <b>"using IPushServerPattern<DataType>::put;"</b>).
+     *
+     *  @param d contains the newly acquired data to be sent as update (must not be null)
+     *
+     *  @return status code (see put() above)
+     *    - SMART_ERROR               : also returned for a null pointer
+     */
+    virtual StatusCode put(const std::shared_ptr<const DataType>& d) {
+        if(!d) return SMART_ERROR;
+        return this->put(*d);
+    }
+
+    /** Returns the sequence number of the latest update (0 if there was none yet)
+     */
+    uint64_t getSequence() {
+        std::unique_lock<std::mutex> lock(sequence_mutex);
+        return update_sequence;
+    }
+
+    /** Sets the keyframe interval of the delta mode.
+     *
+     *  Every keyframeInterval-th update is sent as keyframe (the complete data) and
+     *  the updates in between as differences to that keyframe, computed by
+     *  PushDeltaTraits<DataType>::diff(). Clients reconstruct the updates before
+     *  getUpdate() and the handlers see them. Subscribers that did not receive the
+     *  latest keyframe (e.g. late joiners or subscribers whose prescale factor skipped
+     *  it) get a resync frame once, i.e. the keyframe along with the latest difference,
+     *  and the differences afterwards.
+     *
+     *  @param keyframeInterval the keyframe interval (0 and 1 disable the delta mode, which is the default)
+     */
+    void setKeyframeInterval(const unsigned int &keyframeInterval) {
+        delta_encoder.setKeyframeInterval(keyframeInterval);
+    }
+
+    /// returns the keyframe interval of the delta mode
+    unsigned int getKeyframeInterval() {
+        return delta_encoder.getKeyframeInterval();
+    }
 };
 
 } /* namespace Smart */
@@ -46,6 +46,20 @@
 #ifndef SMARTSOFT_INTERFACES_SMARTIQUERYCLIENTPATTERN_T_H_
 #define SMARTSOFT_INTERFACES_SMARTIQUERYCLIENTPATTERN_T_H_
 
+#include <vector>
+#include <algorithm>
+#include <iostream>
+#include <exception>
+
+// C++11 includes
+#include <chrono>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <future>
+#include <memory>
+#include <functional>
+
 #include "smartIClientPattern.h"
 
 namespace Smart {
@@ -55,10 +69,163 @@ namespace Smart {
  *  Template parameters
  *    - <b>RequestType</b>: request class (Communication Object)
  *    - <b>AnswerType</b>: answer (reply) class (Communication Object)
- *    - <b>QIDType</b>: the QueryId type that encapsulates the middleware-specific unique IDs
+ *    - <b>QIDType</b>: the QueryId type that encapsulates the middleware-specific unique IDs (e.g. a SlotMapId
+ *                       of the SlotMap that keeps the pending queries)
  */
 template<class RequestType, class AnswerType, class QIDType>
 class IQueryClientPattern : public IClientPattern {
+public:
+    /// the completion callback of queryAsync(), called with the status (see queryReceive()) and the answer
+    typedef std::function<void(const StatusCode &status, const AnswerType &answer)> QueryCallback;
+    /// the result of queryFuture(), i.e. the status (see queryReceive()) and the answer
+    typedef std::pair<StatusCode,AnswerType> QueryResult;
+    /// the chunk callback of queryStream(), called with the status (see queryReceive()), the next chunk and whether it is the last one
+    typedef std::function<void(const StatusCode &status, const AnswerType &chunk, const bool &lastChunk)> QueryChunkCallback;
+
+private:
+    struct AsyncQuery {
+        QIDType id;
+        QueryCallback callback;
+        // queryReceive() is due (the answer has been notified or the query is new)
+        bool ready;
+    };
+    std::mutex async_mutex;
+    std::condition_variable async_cond_var;
+    std::vector<AsyncQuery> async_queries;
+    std::thread async_thread;
+    bool async_running;
+    bool async_stopped;
+    // the middleware calls notify_answer(), otherwise the dispatcher has to poll
+    bool answer_notifications;
+
+    void complete_async_query(const QueryCallback &callback, const StatusCode &status, AnswerType &answer) {
+        std::function<void()> job = std::bind(callback, status, std::move(answer));
+        IExecutor *executor = (this->icomponent != 0)? this->icomponent->getExecutor() : 0;
+        if(executor == 0 || executor->post(job) != SMART_OK) {
+            job();
+        }
+    }
+
+    // a single dispatcher per client receives the notified async queries and exits if there are none left
+    void async_dispatch_loop() {
+        std::vector<QIDType> ids;
+        AnswerType answer;
+        std::chrono::milliseconds poll_interval(1);
+        std::unique_lock<std::mutex> lock(async_mutex);
+        while(true) {
+            if(async_stopped || async_queries.empty()) {
+                async_running = false;
+                return;
+            }
+            ids.clear();
+            for(auto it=async_queries.begin(); it!=async_queries.end(); it++) {
+                if(it->ready) {
+                    ids.push_back(it->id);
+                    it->ready = false;
+                }
+            }
+            if(ids.empty()) {
+                if(answer_notifications) {
+                    async_cond_var.wait(lock);
+                } else if(async_cond_var.wait_for(lock, poll_interval) == std::cv_status::timeout) {
+                    // fallback for middlewares that do not call notify_answer()
+                    for(auto it=async_queries.begin(); it!=async_queries.end(); it++) {
+                        it->ready = true;
+                    }
+                    poll_interval = std::min(poll_interval * 2, std::chrono::milliseconds(16));
+                }
+                continue;
+            }
+
+            // queryReceive() never blocks, thus the middleware is never called with the lock held
+            lock.unlock();
+            for(auto id=ids.begin(); id!=ids.end(); id++) {
+                StatusCode status = this->queryReceive(*id, answer);
+                if(status == SMART_NODATA) continue;
+
+                QueryCallback callback;
+                {
+                    std::unique_lock<std::mutex> query_lock(async_mutex);
+                    for(auto it=async_queries.begin(); it!=async_queries.end(); it++) {
+                        if(it->id == *id) {
+                            callback.swap(it->callback);
+                            *it = async_queries.back();
+                            async_queries.pop_back();
+                            break;
+                        }
+                    }
+                }
+                if(callback) this->complete_async_query(callback, status, answer);
+                poll_interval = std::chrono::milliseconds(1);
+            }
+            lock.lock();
+        }
+    }
+
+protected:
+    /** Stops the async query dispatcher
+     *
+     *  Queries started by queryAsync() or queryFuture() which are still pending are discarded
+     *  (see queryDiscard()) and completed with SMART_CANCELLED (within the calling thread); later
+     *  calls of queryAsync() are rejected. Since the dispatcher calls queryReceive() and this method
+     *  calls queryDiscard(), middleware implementations have to call this method at the beginning of
+     *  their destructor (unless they never use the default queryAsync()). The destructor of this class
+     *  terminates the process if the dispatcher is still running.
+     *  This method is also called by on_shutdown() after the client has been disconnected.
+     */
+    void stop_async_queries() {
+        std::vector<AsyncQuery> cancelled_queries;
+        {
+            std::unique_lock<std::mutex> lock(async_mutex);
+            async_stopped = true;
+            async_cond_var.notify_all();
+        }
+        if(async_thread.joinable() && async_thread.get_id() != std::this_thread::get_id()) {
+            async_thread.join();
+        }
+        {
+            std::unique_lock<std::mutex> lock(async_mutex);
+            cancelled_queries.swap(async_queries);
+        }
+        for(auto it=cancelled_queries.begin(); it!=cancelled_queries.end(); it++) {
+            // the middleware releases the query while the derived class is still alive
+            this->queryDiscard(it->id);
+            it->callback(SMART_CANCELLED, AnswerType());
+        }
+    }
+
+    /** Informs the async query dispatcher that the query <I>id</I> can be received.
+     *
+     *  Middleware implementations call this method from their receive path whenever queryReceive()
+     *  would not return SMART_NODATA anymore for a query (i.e. the answer arrived, the query has
+     *  been rejected or aborted by a disconnect). The dispatcher then sleeps until it is notified
+     *  and only receives the notified queries. Without these notifications, the dispatcher falls
+     *  back to polling all pending async queries (every 1 to 16 milliseconds). Notifications of
+     *  queries that are not pending in queryAsync() are ignored.
+     *
+     *  @param id  the identifier of the query that can be received
+     */
+    void notify_answer(const QIDType &id) {
+        std::unique_lock<std::mutex> lock(async_mutex);
+        answer_notifications = true;
+        for(auto it=async_queries.begin(); it!=async_queries.end(); it++) {
+            if(it->id == id) {
+                it->ready = true;
+                async_cond_var.notify_one();
+                break;
+            }
+        }
+    }
+
+    /** implements the shutdown strategy of query clients
+     *  The client is disconnected (which completes the pending async
+     *  queries) and the async query dispatcher is stopped afterwards.
+     */
+    virtual void on_shutdown() {
+        IClientPattern::on_shutdown();
+        this->stop_async_queries();
+    }
+
 public:
     /** Constructor (not wired with any service provider).
      *
@@ -69,6 +236,9 @@ public:
      */
 	IQueryClientPattern(IComponent* component)
 	:	IClientPattern(component)
+	,	async_running(false)
+	,	async_stopped(false)
+	,	answer_notifications(false)
 	{  }
 
     /** Connection Constructor (implicitly wiring with specified service provider).
@@ -85,19 +255,39 @@ public:
      */
 	IQueryClientPattern(IComponent* component, const std::string& server, const std::string& service)
 	:	IClientPattern(component, server, service)
+	,	async_running(false)
+	,	async_stopped(false)
+	,	answer_notifications(false)
 	{  }
 
     /** Destructor.
      *  The destructor calls disconnect() and therefore properly cleans up
      *  every pending query and removes the instance from the set of wireable ports.
+     *  See stop_async_queries() regarding pending async queries.
      */
-    virtual ~IQueryClientPattern() {  }
+    virtual ~IQueryClientPattern() {
+        {
+            std::unique_lock<std::mutex> lock(async_mutex);
+            if(async_running == true) {
+                // the dispatcher would call queryReceive() of the already destroyed derived class
+                std::cerr << "IQueryClientPattern: middleware destructors have to call stop_async_queries()" << std::endl;
+                std::terminate();
+            }
+            async_stopped = true;
+        }
+        // the dispatcher has already returned (there are no pending async queries left)
+        if(async_thread.joinable()) async_thread.join();
+    }
 
     /** Blocking Query.
      *
      *  Perform a blocking query and return only when the query answer
      *  is available. Member function is thread safe and thread reentrant.
      *
+     *  A streamed answer (see IQueryServerPattern::answerChunk()) is returned after it has been
+     *  assembled completely (see QueryAnswerChunkTraits); this also applies to queryReceive() and
+     *  queryReceiveWait().
+     *
      *  @param request send this request to the server (Communication Object)
      *  @param answer  returned answer from the server (Communication Object)
      *
@@ -110,6 +300,8 @@ public:
      *                                  can be made or it got disconnected and a pending
      *                                  query is aborted without answer. In both cases,
      *                                  <I>answer</I> is not valid.
+     *    - SMART_OVERLOADED          : the server rejected the request due to overload (see
+     *                                  IQueryServerPattern::rejectQuery()), <I>answer</I> is not valid.
      *    - SMART_ERROR_COMMUNICATION : communication problems, <I>answer</I> is not valid.
      *    - SMART_ERROR               : something went wrong, <I>answer</I> is not valid.
      */
@@ -134,6 +326,26 @@ public:
      */
     virtual StatusCode queryRequest(const RequestType& request, QIDType& id) = 0;
 
+    /** Asynchronous Query with a deadline.
+     *
+     *  Same as queryRequest(), but the server is informed that the answer is not needed after
+     *  <I>timeout</I> (measured from now). The server skips the request if it has not started
+     *  processing it in time, and handlers can abort it (see IQueryServerPattern::isQueryCancelled()).
+     *  The timeout is transmitted relative, so the clocks of client and server need not be synchronized.
+     *  The default implementation calls queryRequest() without transmitting the timeout; middleware
+     *  implementations should override this method.
+     *
+     *  @param request send this request to the server (Communication Object)
+     *  @param id      is set to the identifier which is later used to receive
+     *                 the reply to this request
+     *  @param timeout the time after which the answer is not needed anymore
+     *
+     *  @return status code (see queryRequest())
+     */
+    virtual StatusCode queryRequestWithTimeout(const RequestType& request, QIDType& id, const std::chrono::steady_clock::duration &) {
+        return this->queryRequest(request, id);
+    }
+
     /** Check if answer is available.
      *
      *  Non-blocking call to fetch the answer belonging to the given identifier.
@@ -155,6 +367,8 @@ public:
      *    - SMART_DISCONNECTED : the answer belonging to the <I>id</I> can not be received
      *                           anymore since the client got disconnected. <I>id</I> is
      *                           not valid any longer and <I>answer</I> contains no valid answer.
+     *    - SMART_OVERLOADED   : the server rejected the request due to overload. <I>id</I> is not valid
+     *                           any longer and <I>answer</I> contains no valid answer.
      *    - SMART_ERROR        : something went wrong, <I>answer</I> contains no answer and <I>id</I> is
      *                           not valid any longer.
      *
@@ -186,6 +400,8 @@ public:
      *    - SMART_DISCONNECTED : blocking call is aborted and the answer belonging to <I>id</I> can not
      *                           be received anymore since client got disconnected. <I>id</I> is not valid
      *                           any longer and <I>answer</I> contains no valid answer.
+     *    - SMART_OVERLOADED   : the server rejected the request due to overload. <I>id</I> is not valid
+     *                           any longer and <I>answer</I> contains no valid answer.
      *    - SMART_ERROR        : something went wrong, <I>answer</I> contains no answer and <I>id</I> is
      *                           not valid any longer.
      *
@@ -196,6 +412,8 @@ public:
      *
      *  Call this member function if you do not want to get the answer of a request anymore which
      *  was invoked by queryRequest(). This member function invalidates the identifier <I>id</I>.
+     *  Implementations should inform the server, so that it can skip or abort the request
+     *  (see IQueryServerPattern::isQueryCancelled()).
      *
      *  @warning
      *    This member function does NOT abort blocking calls ! This is done by the blocking() member
@@ -216,6 +434,175 @@ public:
      *
      */
     virtual StatusCode queryDiscard(const QIDType& id) = 0;
+
+    /** Asynchronous Batch Query.
+     *
+     *  Performs queryRequest() for each request and returns immediately. The default implementation
+     *  sends the requests one after another; middleware implementations can override this method to
+     *  send all requests within a single transaction. Member function is thread safe and reentrant.
+     *
+     *  @param requests send these requests to the server (Communication Objects)
+     *  @param ids      is set to the identifiers of the sent requests (in the order of the requests)
+     *
+     *  @return status code:
+     *    - SMART_OK                  : everything is ok and <I>ids</I> contains one identifier per request
+     *    - otherwise the status code of the first failed queryRequest() (see above). Sending stops at
+     *      this request and <I>ids</I> only contains the identifiers of the requests sent before (which
+     *      remain valid and need to be received or discarded).
+     */
+    virtual StatusCode queryRequestBatch(const std::vector<RequestType>& requests, std::vector<QIDType>& ids) {
+        ids.clear();
+        ids.reserve(requests.size());
+        for(auto it=requests.begin(); it!=requests.end(); it++) {
+            QIDType id;
+            StatusCode status = this->queryRequest(*it, id);
+            if(status != SMART_OK) return status;
+            ids.push_back(id);
+        }
+        return SMART_OK;
+    }
+
+    /** Wait for the first reply of several queries.
+     *
+     *  Blocking call that waits until any of the given queries can be received (i.e. until queryReceive()
+     *  would not return SMART_NODATA for it), which avoids head-of-line blocking of scatter-gather clients.
+     *  The ready query is received and its identifier is returned in <I>readyId</I>; all other identifiers
+     *  remain valid. The default implementation polls queryReceive() with an exponential backoff (up to one
+     *  millisecond); middleware implementations should override it with an event-driven wait.
+     *
+     *  @warning
+     *    It is not allowed to call queryReceive(), queryReceiveWait() or queryDiscard() concurrently
+     *    with any of the given query ids
+     *
+     *  @param ids      provides the identifiers of the queries to wait for
+     *  @param readyId  is set to the identifier of the query whose result is returned
+     *  @param answer   is set to the answer of the query <I>readyId</I> if it was available
+     *  @param timeout  is the timeout time to block the method maximally (default value zero block infinitelly)
+     *
+     *  @return status code:
+     *    - SMART_OK           : everything is ok and <I>answer</I> contains the answer of <I>readyId</I>
+     *    - SMART_WRONGID, SMART_DISCONNECTED, SMART_OVERLOADED, SMART_ERROR : see queryReceive(), the status refers to <I>readyId</I>
+     *    - SMART_TIMEOUT      : none of the queries has been answered in time, all identifiers keep valid
+     *    - SMART_CANCELLED    : blocking call is not allowed or is not allowed anymore, all identifiers keep valid
+     *    - SMART_NODATA       : the list of identifiers is empty
+     */
+    virtual StatusCode queryReceiveAny(const std::vector<QIDType>& ids, QIDType& readyId, AnswerType& answer, const std::chrono::steady_clock::duration &timeout=std::chrono::steady_clock::duration::zero()) {
+        if(ids.empty()) return SMART_NODATA;
+        const std::chrono::steady_clock::time_point deadline = std::chrono::steady_clock::now() + timeout;
+        std::chrono::microseconds backoff(10);
+        while(true) {
+            for(auto it=ids.begin(); it!=ids.end(); it++) {
+                StatusCode status = this->queryReceive(*it, answer);
+                if(status != SMART_NODATA) {
+                    readyId = *it;
+                    return status;
+                }
+            }
+            if(this->is_blocking == false) return SMART_CANCELLED;
+            if(timeout != std::chrono::steady_clock::duration::zero() && std::chrono::steady_clock::now() >= deadline) return SMART_TIMEOUT;
+            std::this_thread::sleep_for(backoff);
+            backoff = std::min(backoff * 2, std::chrono::microseconds(1000));
+        }
+    }
+
+    /** Asynchronous Query with completion callback.
+     *
+     *  Performs queryRequest() and returns immediately. As soon as the answer arrives, the
+     *  <I>callback</I> is executed on the component's executor (see IComponent::getExecutor(),
+     *  the callback is called directly if there is no executor). The query is never cancelled
+     *  by blocking(false) and the callback is called exactly once if SMART_OK is returned.
+     *
+     *  The default implementation uses a single dispatcher thread per client for all outstanding
+     *  async queries, which is started by the first async query, only runs while async queries are
+     *  pending and waits for notify_answer() of the middleware. Middleware implementations can
+     *  override this method to complete the queries directly from their receive path. Member
+     *  function is thread safe and reentrant.
+     *
+     *  @param request  send this request to the server (Communication Object)
+     *  @param callback is called with the status (see queryReceive()) and the answer
+     *
+     *  @return status code:
+     *    - SMART_OK                  : everything is ok and <I>callback</I> will be called
+     *    - SMART_CANCELLED           : the client has been shut down, the request is not sent
+     *    - otherwise the status code of queryRequest() and <I>callback</I> is never called
+     */
+    virtual StatusCode queryAsync(const RequestType& request, const QueryCallback& callback) {
+        {
+            std::unique_lock<std::mutex> lock(async_mutex);
+            if(async_stopped) return SMART_CANCELLED;
+        }
+        QIDType id;
+        StatusCode status = this->queryRequest(request, id);
+        if(status != SMART_OK) return status;
+
+        std::unique_lock<std::mutex> lock(async_mutex);
+        if(async_stopped) {
+            // the client has been shut down concurrently
+            lock.unlock();
+            this->queryDiscard(id);
+            return SMART_CANCELLED;
+        }
+        AsyncQuery query;
+        query.id = id;
+        query.callback = callback;
+        // the answer might have been notified before the query has been added
+        query.ready = true;
+        async_queries.push_back(query);
+        async_cond_var.notify_one();
+        if(!async_running) {
+            // a previous dispatcher has already left its loop (or there was none yet)
+            if(async_thread.joinable()) async_thread.join();
+            async_running = true;
+            async_thread = std::thread(&IQueryClientPattern::async_dispatch_loop, this);
+        }
+        return SMART_OK;
+    }
+
+    /** Asynchronous Query with incremental reception of a streamed answer.
+     *
+     *  Performs queryRequest() and returns immediately. The <I>callback</I> is executed (like in
+     *  queryAsync()) for each chunk of the answer as soon as it arrives, so that large answers can
+     *  be processed without assembling them in memory (see IQueryServerPattern::answerChunk()).
+     *  The callback is called at least once and the last call has <I>lastChunk</I> set to true;
+     *  a status other than SMART_OK always comes with <I>lastChunk</I> set to true. Answers that
+     *  are not streamed by the server arrive as a single chunk. The chunks of a query are delivered
+     *  sequentially and in order.
+     *
+     *  The default implementation uses queryAsync() and therefore delivers the assembled answer
+     *  as a single chunk; middleware implementations supporting streamed answers should override it.
+     *
+     *  @param request  send this request to the server (Communication Object)
+     *  @param callback is called with the status, each chunk and whether it is the last one
+     *
+     *  @return status code (see queryAsync())
+     */
+    virtual StatusCode queryStream(const RequestType& request, const QueryChunkCallback& callback) {
+        return this->queryAsync(request, [callback](const StatusCode &status, const AnswerType &answer) {
+            callback(status, answer, true);
+        });
+    }
+
+    /** Asynchronous Query returning a future.
+     *
+     *  Same as queryAsync(), the returned future becomes ready with the status (see queryReceive())
+     *  and the answer as soon as the answer arrives. If the query can not be sent, the future is
+     *  ready immediately and contains the status code of queryAsync().
+     *
+     *  @param request  send this request to the server (Communication Object)
+     *
+     *  @return the future of the query result
+     */
+    std::future<QueryResult> queryFuture(const RequestType& request) {
+        std::shared_ptr< std::promise<QueryResult> > promise = std::make_shared< std::promise<QueryResult> >();
+        std::future<QueryResult> result = promise->get_future();
+        StatusCode status = this->queryAsync(request, [promise](const StatusCode &query_status, const AnswerType &answer) {
+            promise->set_value(QueryResult(query_status, answer));
+        });
+        if(status != SMART_OK) {
+            promise->set_value(QueryResult(status, AnswerType()));
+        }
+        return result;
+    }
 };
 
 } /* namespace Smart */
@@ -46,9 +46,19 @@
 #ifndef SMARTSOFT_INTERFACES_SMARTIQUERYSERVERPATTERN_T_H_
 #define SMARTSOFT_INTERFACES_SMARTIQUERYSERVERPATTERN_T_H_
 
+#include <map>
+#include <algorithm>
+#include <vector>
+#include <utility>
+
+// C++11 includes
+#include <chrono>
+#include <mutex>
+
 #include "smartIInputHandler_T.h"
 #include "smartIServerPattern.h"
 #include "smartQueryStatus.h"
+#include "smartQueryAnswerChunkTraits_T.h"
 
 namespace Smart {
 
@@ -61,6 +71,12 @@ template<class RequestType, class QIDType>
 struct QueryServerInputType {
 	RequestType request;
 	QIDType query_id;
+	/// the server-local deadline of the request (time_point::max() if the client did not provide one)
+	std::chrono::steady_clock::time_point deadline;
+
+	QueryServerInputType()
+	:	deadline(std::chrono::steady_clock::time_point::max())
+	{  }
 };
 
 /** Handler Class for QueryServer for incoming requests.
@@ -83,9 +99,26 @@ protected:
 	 *  extracting the input attributes from the composed QueryServerInputType
 	 */
 	virtual void handle_input(const QueryServerInputType<RequestType,QIDType>& input) {
+		if(input.deadline != std::chrono::steady_clock::time_point::max() && input.deadline <= std::chrono::steady_clock::now()) {
+			// nobody waits for the answer anymore
+			if(this->on_request_expired(input.query_id) == true) return;
+		}
 		this->handleQuery(input.query_id, input.request);
 	}
 
+	/** user hook that is called for each request that can be skipped because it expired or was cancelled
+	 *
+	 *  The default implementation calls IQueryServerPattern::discardQuery() for the request.
+	 *
+	 *  @param id the id of the expired request
+	 *
+	 *  @return true if the request has been dropped or false if it has to be processed as usual
+	 *          (e.g. because the middleware does not support discardQuery())
+	 */
+	virtual bool on_request_expired(const QIDType &id) {
+		return this->server->discardQuery(id) == SMART_OK;
+	}
+
 public:
 	/** Default constructor
 	 *
@@ -121,6 +154,10 @@ public:
    *  the result. The ThreadedQueryHandler decorator provides such
    *  a processing pattern.
    *
+   *  Requests whose deadline has already passed are not handed to this method
+   *  (see on_request_expired()). Long running handlers can check whether the answer
+   *  is still needed using <b>"server->isQueryCancelled(id)"</b>.
+   *
    *  @param id       id of new query
    *  @param request the request itself
    */
@@ -140,6 +177,74 @@ class IQueryServerPattern
 :	public IServerPattern
 ,	public InputSubject< QueryServerInputType<RequestType,QIDType> >
 {
+private:
+	std::mutex query_deadlines_mutex;
+	// the deadlines of pending requests that have a deadline or have been cancelled
+	std::map<QIDType, std::chrono::steady_clock::time_point> query_deadlines;
+	// the size of query_deadlines that triggers the next removal of passed deadlines
+	std::size_t query_deadlines_sweep_size;
+
+	// removes passed deadlines once the map doubled, which bounds it even if release_query() is missing (call with locked query_deadlines_mutex)
+	void sweep_query_deadlines() {
+		if(query_deadlines.size() < query_deadlines_sweep_size) return;
+		const std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+		for(auto it=query_deadlines.begin(); it!=query_deadlines.end(); ) {
+			if(it->second <= now) {
+				it = query_deadlines.erase(it);
+			} else {
+				++it;
+			}
+		}
+		query_deadlines_sweep_size = std::max<std::size_t>(64, 2*query_deadlines.size());
+	}
+
+	std::mutex partial_answers_mutex;
+	// the chunks of streamed answers assembled by the default implementation of answerChunk()
+	std::map<QIDType, AnswerType> partial_answers;
+
+protected:
+	/** Notifies the attached handlers about an incoming request
+	 *
+	 *  Middleware implementations set the <I>deadline</I> of the input from the timeout
+	 *  the client provided (see IQueryClientPattern::queryRequestWithTimeout()), converted
+	 *  into the server's steady clock. A given deadline is kept until release_query(), but
+	 *  at the latest until it has passed and the number of kept deadlines has doubled.
+	 */
+	virtual bool notify_input(const QueryServerInputType<RequestType,QIDType>& input) {
+		if(input.deadline != std::chrono::steady_clock::time_point::max()) {
+			std::unique_lock<std::mutex> lock(query_deadlines_mutex);
+			this->sweep_query_deadlines();
+			query_deadlines[input.query_id] = input.deadline;
+		}
+		return InputSubject< QueryServerInputType<RequestType,QIDType> >::notify_input(input);
+	}
+
+	/** Marks a pending request as cancelled
+	 *
+	 *  Middleware implementations call this method if the client does not wait for the answer
+	 *  anymore (e.g. after IQueryClientPattern::queryDiscard() or a disconnect).
+	 */
+	void cancel_query(const QIDType &id) {
+		std::unique_lock<std::mutex> lock(query_deadlines_mutex);
+		this->sweep_query_deadlines();
+		query_deadlines[id] = std::chrono::steady_clock::time_point::min();
+	}
+
+	/** Releases the deadline and the chunks of an aborted streamed answer of a request
+	 *
+	 *  Middleware implementations that set deadlines (see notify_input()) or call cancel_query() have
+	 *  to call this method as soon as a request has been answered, discarded or rejected. Middlewares
+	 *  that do neither only need to call it from discardQuery() and rejectQuery().
+	 */
+	void release_query(const QIDType &id) {
+		{
+			std::unique_lock<std::mutex> lock(query_deadlines_mutex);
+			query_deadlines.erase(id);
+		}
+		std::unique_lock<std::mutex> lock(partial_answers_mutex);
+		partial_answers.erase(id);
+	}
+
 public:
     /** Default constructor.
      *
@@ -151,6 +256,7 @@ public:
      */
 	IQueryServerPattern(IComponent* component, const std::string& service)
 	:	IServerPattern(component, service)
+	,	query_deadlines_sweep_size(64)
 	{  }
 
     /** Destructor.
@@ -162,7 +268,8 @@ public:
 
     /** Provide answer to be sent back to the requestor.
      *
-     *  Member function is thread safe and thread reentrant.
+     *  Member function is thread safe and thread reentrant. Implementations
+     *  call release_query() for the answered request.
      *
      *  @param id identifies the request to which the answer belongs
      *  @param answer is the reply itself.
@@ -176,6 +283,142 @@ public:
      *    - SMART_ERROR               : something went wrong
      */
     virtual StatusCode answer(const QIDType& id, const AnswerType& answer) = 0;
+
+    /** Provide several answers at once.
+     *
+     *  The default implementation calls answer() for each entry. Middleware implementations
+     *  can override this method to send all answers within a single transaction.
+     *
+     *  Member function is thread safe and thread reentrant.
+     *
+     *  @param answers the pairs of request ids and their answers
+     *
+     *  @return status code:
+     *    - SMART_OK                  : all answers have been sent
+     *    - otherwise the status code of the first failed answer() (see above); all
+     *      other answers are sent nevertheless
+     */
+    virtual StatusCode answerBatch(const std::vector< std::pair<QIDType,AnswerType> > &answers) {
+        StatusCode result = SMART_OK;
+        for(auto it=answers.begin(); it!=answers.end(); it++) {
+            StatusCode status = this->answer(it->first, it->second);
+            if(status != SMART_OK && result == SMART_OK) result = status;
+        }
+        return result;
+    }
+
+    /** Provide the next chunk of a streamed answer.
+     *
+     *  Instead of calling answer() once with the whole answer, large answers (e.g. maps or point
+     *  clouds) can be provided in several chunks, which reduces the time to the first data and
+     *  the peak memory of both server and client. The chunks are appended in order on the client
+     *  side (see QueryAnswerChunkTraits), the last chunk completes the query. Clients receive the
+     *  assembled answer as usual or each chunk as soon as it arrives (see IQueryClientPattern::queryStream()).
+     *
+     *  The default implementation assembles the chunks in memory and calls answer() with the
+     *  complete answer after the last chunk; middleware implementations should override this
+     *  method to transmit each chunk immediately.
+     *
+     *  Member function is thread safe and thread reentrant, but the chunks of one answer must be
+     *  provided sequentially.
+     *
+     *  @param id        identifies the request to which the chunk belongs
+     *  @param chunk     the next part of the answer
+     *  @param lastChunk true for the final chunk of the answer
+     *
+     *  @return status code (see answer()), an error aborts the streamed answer:
+     *    - SMART_NOTALLOWED          : the AnswerType can not be assembled from several chunks
+     *                                  (see QueryAnswerChunkTraits)
+     */
+    virtual StatusCode answerChunk(const QIDType& id, const AnswerType& chunk, const bool &lastChunk) {
+        AnswerType assembled;
+        {
+            std::unique_lock<std::mutex> lock(partial_answers_mutex);
+            auto it = partial_answers.find(id);
+            if(it == partial_answers.end() && lastChunk) {
+                // an answer that consists of a single chunk
+                lock.unlock();
+                return this->answer(id, chunk);
+            }
+            if(it == partial_answers.end()) {
+                it = partial_answers.insert(std::make_pair(id, AnswerType())).first;
+            }
+            if(!QueryAnswerChunkTraits<AnswerType>::append(it->second, chunk)) {
+                partial_answers.erase(it);
+                return SMART_NOTALLOWED;
+            }
+            if(!lastChunk) return SMART_OK;
+            using std::swap;
+            swap(assembled, it->second);
+            partial_answers.erase(it);
+        }
+        return this->answer(id, assembled);
+    }
+
+    /** Returns the deadline of a pending request.
+     *
+     *  @param id identifies the request
+     *
+     *  @return the server-local deadline (time_point::max() if the request has none,
+     *          time_point::min() if the request has been cancelled by the client)
+     */
+    virtual std::chrono::steady_clock::time_point getQueryDeadline(const QIDType& id) {
+        std::unique_lock<std::mutex> lock(query_deadlines_mutex);
+        auto it = query_deadlines.find(id);
+        return (it != query_deadlines.end())? it->second : std::chrono::steady_clock::time_point::max();
+    }
+
+    /** Checks whether the answer of a pending request is still needed.
+     *
+     *  Handlers can call this method during long computations to abort requests whose
+     *  deadline has passed or that have been cancelled by the client.
+     *  Member function is thread safe and thread reentrant.
+     *
+     *  @param id identifies the request
+     *
+     *  @return true if the request expired or has been cancelled
+     */
+    virtual bool isQueryCancelled(const QIDType& id) {
+        const std::chrono::steady_clock::time_point deadline = this->getQueryDeadline(id);
+        return deadline != std::chrono::steady_clock::time_point::max() && deadline <= std::chrono::steady_clock::now();
+    }
+
+    /** Drops a request without computing its answer (e.g. because it expired).
+     *
+     *  Middleware implementations override this method to release the request without sending
+     *  an answer (the client does not wait for it anymore) and call release_query(). The default
+     *  implementation does not support dropping requests: the request remains pending and has
+     *  to be answered as usual (see IQueryServerHandler::on_request_expired()).
+     *
+     *  @param id identifies the request
+     *
+     *  @return status code:
+     *    - SMART_OK                  : the request has been dropped
+     *    - SMART_NOTALLOWED          : dropping requests is not supported, the request remains pending
+     *    - otherwise see answer()
+     */
+    virtual StatusCode discardQuery(const QIDType&) {
+        return SMART_NOTALLOWED;
+    }
+
+    /** Rejects a request without computing its answer (e.g. due to overload).
+     *
+     *  The requesting client receives SMART_OVERLOADED instead of an answer, so that it can
+     *  fail over quickly instead of waiting for a timeout. Middleware implementations override
+     *  this method to transmit the rejection (see QUERY_REJECTED) and call release_query(). The
+     *  default implementation does not support rejections: the request remains pending and has
+     *  to be answered as usual.
+     *
+     *  @param id identifies the request
+     *
+     *  @return status code:
+     *    - SMART_OK                  : the rejection has been sent to the requesting client
+     *    - SMART_NOTALLOWED          : rejections are not supported, the request remains pending
+     *    - otherwise see answer()
+     */
+    virtual StatusCode rejectQuery(const QIDType&) {
+        return SMART_NOTALLOWED;
+    }
 };
 
 } /* namespace Smart */
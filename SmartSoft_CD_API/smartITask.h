@@ -48,6 +48,7 @@
 
 #include "smartIShutdownObserver.h"
 #include "smartIComponent.h"
+#include "smartTaskSchedulingParameters.h"
 
 namespace Smart {
 
@@ -62,6 +63,9 @@ namespace Smart {
  */
 class ITask : public IShutdownObserver {
 protected:
+	/// the scheduling parameters used for the internal thread (see set_scheduling_parameters())
+	TaskSchedulingParameters scheduling_parameters;
+
 	/** Default implementation of the IShutdownObserver interface
 	 *
 	 * 	The default shutdown procedure is to call the stop() method which triggers
@@ -128,6 +132,28 @@ public:
      *  @return 0 on success or -1 on failure
      */
     virtual int stop(const bool wait_till_stopped=true) = 0;
+
+    /** Sets the scheduling parameters (policy, priority, CPU affinity, thread name and stack size)
+     *
+     *  The parameters are used by start() when the internal thread is created.
+     *  Implementations typically set the stack size as a thread attribute and call
+     *  applyThreadSchedulingParameters() as the first statement of the new thread.
+     *  Implementations may overload this method to also apply the parameters to an
+     *  already running thread.
+     *
+     *  @param parameters the new scheduling parameters
+     *
+     *  @return 0 on success or -1 on failure
+     */
+    virtual int set_scheduling_parameters(const TaskSchedulingParameters &parameters) {
+        this->scheduling_parameters = parameters;
+        return 0;
+    }
+
+    /// returns the currently set scheduling parameters
+    inline TaskSchedulingParameters get_scheduling_parameters() const {
+        return scheduling_parameters;
+    }
 };
 
 } /* namespace Smart */
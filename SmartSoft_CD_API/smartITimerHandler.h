@@ -50,6 +50,16 @@
 
 namespace Smart {
 
+/** The handler interface for timer expiries (see ITimerManager)
+ *
+ *  A timer manager only keeps a plain pointer to the handler of each timer. Therefore all
+ *  timers of a handler have to be removed from their timer managers before the handler is
+ *  destroyed, typically by calling ITimerManager::cancelTimersOf(this) within the destructor
+ *  of the most derived class (while the handler is still fully intact). Timer managers that
+ *  execute upcalls in other threads (see TimerManagerBase) let cancelTimersOf() wait for
+ *  these upcalls to finish, so no upcall can reach the handler afterwards. The TimedTaskTrigger
+ *  records its timer manager and does this in its own destructor (see TimedTaskTrigger::stop()).
+ */
 class ITimerHandler {
 public:
 	ITimerHandler() { }
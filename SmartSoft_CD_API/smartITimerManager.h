@@ -47,9 +47,78 @@
 #define SMARTSOFT_INTERFACES_SMARTITIMERMANAGER_H_
 
 #include "smartITimerHandler.h"
+#include "smartTimerHistogram.h"
+#include "smartTaskSchedulingParameters.h"
 
 namespace Smart {
 
+/// statistics about the timer coalescing of an ITimerManager (see ITimerManager::scheduleTimerWithSlack())
+struct TimerCoalescingStatistics {
+	/// the number of wakeups that expired at least one timer
+	unsigned long wakeups;
+	/// the total number of timer expiries
+	unsigned long expiries;
+	/// the number of wakeups saved by coalescing timers with different deadlines into a single wakeup
+	unsigned long savedWakeups;
+
+	TimerCoalescingStatistics()
+	:	wakeups(0)
+	,	expiries(0)
+	,	savedWakeups(0)
+	{  }
+};
+
+/** The mode in which an ITimerManager executes the ITimerHandler::timerExpired() upcalls
+ *
+ *  In the worker modes the expiry detection is decoupled from the handler execution,
+ *  so that a long running handler does not delay the expiry of other timers.
+ */
+enum TimerDispatchMode {
+	/// upcalls are executed one after another within the timer thread itself
+	TIMER_DISPATCH_INLINE = 0,
+	/// upcalls are executed by a pool of worker threads (upcalls of the same handler may run concurrently)
+	TIMER_DISPATCH_WORKER_POOL,
+	/// upcalls are executed by a pool of worker threads, but the upcalls of each handler are serialized in expiry order
+	/// (an expiry of a timer that still has a queued upcall is skipped instead of building up a backlog)
+	TIMER_DISPATCH_SERIAL_PER_HANDLER
+};
+
+/** Statistics about the timeliness of timer upcalls
+ *
+ *  The delay of an upcall is split into the time the timer manager needed to detect the expiry
+ *  (fire lateness) and the time the expiry waited for a free dispatch thread (dispatch delay), the
+ *  latter being caused by other (long running) handlers. The handler runtime is the duration of the upcall.
+ */
+struct TimerLatenessStatistics {
+	/// the number of executed upcalls
+	unsigned long count;
+	/// the maximum time between the scheduled expiry and its detection by the timer manager
+	std::chrono::steady_clock::duration maxFireLateness;
+	/// the accumulated fire lateness of all upcalls
+	std::chrono::steady_clock::duration totalFireLateness;
+	/// the maximum time between the detection of an expiry and the start of its upcall
+	std::chrono::steady_clock::duration maxDispatchDelay;
+	/// the accumulated dispatch delay of all upcalls
+	std::chrono::steady_clock::duration totalDispatchDelay;
+	/// the maximum duration of an upcall
+	std::chrono::steady_clock::duration maxHandlerRuntime;
+	/// the accumulated duration of all upcalls
+	std::chrono::steady_clock::duration totalHandlerRuntime;
+	/// the number of expiries skipped because the previous upcall of the same timer was still queued
+	unsigned long skippedExpiries;
+
+	TimerLatenessStatistics()
+	:	count(0)
+	,	maxFireLateness(std::chrono::steady_clock::duration::zero())
+	,	totalFireLateness(std::chrono::steady_clock::duration::zero())
+	,	maxDispatchDelay(std::chrono::steady_clock::duration::zero())
+	,	totalDispatchDelay(std::chrono::steady_clock::duration::zero())
+	,	maxHandlerRuntime(std::chrono::steady_clock::duration::zero())
+	,	totalHandlerRuntime(std::chrono::steady_clock::duration::zero())
+	,	skippedExpiries(0)
+	{  }
+};
+
 class ITimerManager {
 public:
 	typedef long TimerId;
@@ -63,6 +132,30 @@ public:
 			const std::chrono::steady_clock::duration &interval=std::chrono::steady_clock::duration::zero()
 		) = 0;
 
+	/** Schedules a (one-shot or periodic) timer that tolerates a delayed expiry
+	 *
+	 *  Timers with a non-zero slack may expire up to <i>slack</i> after their deadline. The timer manager
+	 *  uses this tolerance to batch expiries that fall within each other's windows into a single wakeup,
+	 *  which reduces CPU wakeups for timers that don't need exact expiry (e.g. status publishing,
+	 *  watchdogs or housekeeping). The default implementation ignores the slack and calls scheduleTimer().
+	 *
+	 *  @param handler the handler to call on each expiry
+	 *  @param first_time the relative time of the first expiry
+	 *  @param interval the interval of subsequent expiries (zero for one-shot timers)
+	 *  @param slack the tolerance by which each expiry may be delayed (zero for exact expiry)
+	 *
+	 *  @return the id of the new timer or -1 on failure
+	 */
+	virtual TimerId scheduleTimerWithSlack(
+			ITimerHandler *handler,
+			const std::chrono::steady_clock::duration &first_time,
+			const std::chrono::steady_clock::duration &interval,
+			const std::chrono::steady_clock::duration &
+		)
+	{
+		return this->scheduleTimer(handler, first_time, interval);
+	}
+
 	virtual int cancelTimer(const TimerId& id) = 0;
 
 	virtual int resetTimerInterval(
@@ -70,9 +163,109 @@ public:
 			const std::chrono::steady_clock::duration &interval
 		) = 0;
 
+	/** Cancels all timers of a handler
+	 *
+	 *  Handlers call this method within their destructor, since timer managers do not
+	 *  track the lifetime of the handlers (see ITimerHandler).
+	 *
+	 *  @return the number of cancelled timers or -1 on failure
+	 */
 	virtual int cancelTimersOf(ITimerHandler *handler) = 0;
 
 	virtual void cancelAllTimers() = 0;
+
+	/** Sets the scheduling parameters of the internal dispatch thread(s)
+	 *
+	 *  Implementations that spawn their own thread(s) for dispatching timer expiries
+	 *  apply these parameters to each of these threads (see TaskSchedulingParameters).
+	 *  The default implementation does not support this and returns -1, so that
+	 *  existing timer managers keep compiling.
+	 *
+	 *  @param params the scheduling parameters of the dispatch thread(s)
+	 *
+	 *  @return 0 on success or -1 on failure (or if not supported)
+	 */
+	virtual int setDispatchThreadParameters(const TaskSchedulingParameters &) {
+		return -1;
+	}
+
+	/// returns the statistics about coalesced timer expiries (empty if not supported)
+	virtual TimerCoalescingStatistics getCoalescingStatistics() {
+		return TimerCoalescingStatistics();
+	}
+
+	/** Selects how the timer upcalls are executed
+	 *
+	 *  The default implementation only supports TIMER_DISPATCH_INLINE.
+	 *
+	 *  @param mode the dispatch mode
+	 *  @param workers the number of worker threads (ignored for TIMER_DISPATCH_INLINE)
+	 *
+	 *  @return 0 on success or -1 on failure (or if the mode is not supported)
+	 */
+	virtual int setDispatchMode(const TimerDispatchMode &mode, const unsigned int & =2) {
+		return (mode == TIMER_DISPATCH_INLINE)? 0 : -1;
+	}
+
+	/// returns the statistics about the timeliness of the timer upcalls (empty if not supported)
+	virtual TimerLatenessStatistics getLatenessStatistics() {
+		return TimerLatenessStatistics();
+	}
+
+	/// returns the histograms of the lateness, jitter and handler runtime of all timer upcalls (empty if not supported)
+	virtual TimerLatenessHistograms getLatenessHistograms() {
+		return TimerLatenessHistograms();
+	}
+
+	/// resets the lateness statistics and all (global and per-timer) histograms
+	virtual void resetLatenessStatistics() {  }
+
+	/** Enables (or disables) the recording of separate histograms for a single timer
+	 *
+	 *  Per-timer histograms are opt-in, since they require about 3 KB per timer.
+	 *
+	 *  @param id the id of the timer
+	 *  @param enable true to record histograms for this timer
+	 *
+	 *  @return 0 on success or -1 for an unknown timer id (or if not supported)
+	 */
+	virtual int setTimerStatisticsEnabled(const TimerId &, const bool &) {
+		return -1;
+	}
+
+	/** Returns the histograms of a single timer (see setTimerStatisticsEnabled())
+	 *
+	 *  @param id the id of the timer
+	 *  @param histograms is set to the timer's histograms
+	 *
+	 *  @return 0 on success or -1 if no histograms are recorded for this timer (anymore)
+	 */
+	virtual int getTimerLatenessHistograms(const TimerId &, TimerLatenessHistograms &) {
+		return -1;
+	}
+
+	/** Monitors a percentile of the upcall lateness
+	 *
+	 *  After each window of upcalls the given percentile of their lateness is compared
+	 *  against the threshold and the observer is informed if it is exceeded. This allows
+	 *  to tell whether missed deadlines are caused by the timer subsystem or by the tasks.
+	 *
+	 *  @param observer the observer to inform (0 disables the monitoring)
+	 *  @param threshold the maximum tolerated lateness
+	 *  @param percentile the monitored percentile (e.g. 0.99)
+	 *  @param window the number of upcalls per observation window
+	 *
+	 *  @return 0 on success or -1 for invalid parameters (or if not supported)
+	 */
+	virtual int setLatenessWarning(
+			ITimerLatenessObserver *,
+			const std::chrono::steady_clock::duration &,
+			const double & =0.99,
+			const unsigned int & =1000
+		)
+	{
+		return -1;
+	}
 };
 
 } /* namespace Smart */
@@ -0,0 +1,114 @@
+//===================================================================================
+//
+//  Copyright (C) 2017 Alex Lotz, Dennis Stampfer, Matthias Lutz, Christian Schlegel
+//
+//        lotz@hs-ulm.de
+//        stampfer@hs-ulm.de
+//        lutz@hs-ulm.de
+//        schlegel@hs-ulm.de
+//
+//        Servicerobotik Ulm
+//        Christian Schlegel
+//        Ulm University of Applied Sciences
+//        Prittwitzstr. 10
+//        89075 Ulm
+//        Germany
+//
+//  This file is part of the SmartSoft Component-Developer C++ API.
+//
+//  Redistribution and use in source and binary forms, with or without modification,
+//  are permitted provided that the following conditions are met:
+//
+//  1. Redistributions of source code must retain the above copyright notice,
+//     this list of conditions and the following disclaimer.
+//
+//  2. Redistributions in binary form must reproduce the above copyright notice,
+//     this list of conditions and the following disclaimer in the documentation
+//     and/or other materials provided with the distribution.
+//
+//  3. Neither the name of the copyright holder nor the names of its contributors
+//     may be used to endorse or promote products derived from this software
+//     without specific prior written permission.
+//
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+//  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+//  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+//  IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+//  INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+//  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+//  DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+//  LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE
+//  OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+//  OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+//===================================================================================
+
+#ifndef SMARTSOFT_INTERFACES_SMARTIVIRTUALCLOCK_H_
+#define SMARTSOFT_INTERFACES_SMARTIVIRTUALCLOCK_H_
+
+// C++11 includes
+#include <atomic>
+#include <chrono>
+
+#include "smartITimerManager.h"
+
+namespace Smart {
+
+/** Interface of a simulated clock for faster-than-real-time execution
+ *
+ *  A virtual clock advances its time instantly to the next due timer as soon as
+ *  all participants are idle. Participants are mainly the TaskTriggerObserver
+ *  instances: an observer joins the clock when it waits on its trigger for the first
+ *  time and afterwards counts as busy from the moment it gets triggered until it waits
+ *  on its trigger again (thus, tasks that are constructed but never started do not stall
+ *  the virtual time; triggers they receive before their first wait are kept, but the
+ *  virtual time may advance until they process them). For reproducible runs, all
+ *  tasks should have reached their first wait before the clock starts running.
+ *  Timeouts of TaskTriggerObserver::waitOnTrigger() are measured in virtual time using
+ *  the timer manager of the clock.
+ *
+ *  Observers use the process-wide clock (see setProcessClock()) that is installed
+ *  when they are constructed (or an explicitly set clock, see TaskTriggerObserver::setVirtualClock()).
+ *  The clock must therefore outlive all observers that use it.
+ */
+class IVirtualClock {
+private:
+	static inline std::atomic<IVirtualClock*>& process_clock() {
+		static std::atomic<IVirtualClock*> clock(0);
+		return clock;
+	}
+
+public:
+	virtual ~IVirtualClock() {  }
+
+	/// returns the current virtual time
+	virtual std::chrono::steady_clock::time_point now() = 0;
+
+	/// marks one more participant as busy (the virtual time does not advance while any participant is busy)
+	virtual void enterBusy() = 0;
+
+	/// marks a busy participant as idle again
+	virtual void leaveBusy() = 0;
+
+	/// returns the timer manager that measures timeouts in virtual time
+	virtual ITimerManager* getTimerManager() = 0;
+
+	/// returns the process-wide virtual clock (or 0 if the real time is used)
+	static inline IVirtualClock* getProcessClock() {
+		return process_clock().load();
+	}
+
+	/** Installs a process-wide virtual clock
+	 *
+	 *  Only TaskTriggerObserver instances that are created afterwards use this clock.
+	 *
+	 *  @param clock the virtual clock (0 to use the real time again)
+	 */
+	static inline void setProcessClock(IVirtualClock *clock) {
+		process_clock().store(clock);
+	}
+};
+
+} /* namespace Smart */
+
+#endif /* SMARTSOFT_INTERFACES_SMARTIVIRTUALCLOCK_H_ */
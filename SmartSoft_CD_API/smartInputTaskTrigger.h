@@ -46,20 +46,41 @@
 #ifndef SMARTSOFT_INTERFACES_SMARTINPUTTASKTRIGGER_H_
 #define SMARTSOFT_INTERFACES_SMARTINPUTTASKTRIGGER_H_
 
+#include <mutex>
+
 #include "smartIInputHandler_T.h"
 #include "smartTaskTriggerObserver.h"
+#include "smartLatestValueBuffer_T.h"
 
 
 namespace Smart {
 
+/** Stores the latest input and triggers the attached tasks
+ *
+ *  The latest input is kept in a LatestValueBuffer, i.e. handle_input() never waits
+ *  for tasks that concurrently copy the latest input with getUpdate() and vice versa.
+ *  Since handle_input() might be called by several upcall threads of the middleware,
+ *  the updates are serialized by a mutex that is never locked by getUpdate(). No update
+ *  is ever dropped, regardless of the number of tasks that call getUpdate() at the same time.
+ */
 template <class InputType>
 class InputTaskTrigger
 :	public IInputHandler<InputType>
 ,	public TaskTriggerSubject
 {
 private:
-	Smart::StatusCode updateStatus;
-	InputType lastUpdate;
+	struct UpdateEntry {
+		InputType input;
+		Smart::StatusCode status;
+
+		UpdateEntry()
+		:	status(SMART_NODATA)
+		{  }
+	};
+
+	// serializes the writers of lastUpdate
+	std::mutex updateMutex;
+	LatestValueBuffer<UpdateEntry> lastUpdate;
 
 protected:
 	/** Store a copy of the last update within the internal object
@@ -67,8 +88,12 @@ protected:
 	 * @param updateStatus the optional update status to set (default is SMART_OK)
 	 */
 	inline void setUpdate(const InputType& input, const Smart::StatusCode &updateStatus = Smart::SMART_OK) {
-		this->lastUpdate = input;
-		this->updateStatus = updateStatus;
+		std::unique_lock<std::mutex> lock(updateMutex);
+		// the input is copied directly into a recycled slot of the buffer
+		lastUpdate.writeWith([&input, &updateStatus](UpdateEntry &entry) {
+			entry.input = input;
+			entry.status = updateStatus;
+		});
 	}
 
 	/** This is the main input-handler method that will be automatically called from the given subject
@@ -90,9 +115,7 @@ public:
 	/// Default constructor
 	InputTaskTrigger(InputSubject<InputType> *subject, const unsigned int &prescaleFactor=1)
 	:	IInputHandler<InputType>(subject, prescaleFactor)
-	{
-		updateStatus = SMART_NODATA;
-	}
+	{  }
 	/// Default destructor
 	virtual ~InputTaskTrigger()
 	{ }
@@ -101,13 +124,17 @@ public:
 	 *
 	 * @param update the reference to the InputObject to overwrite
 	 *
-	 * @returns the status code of the last update
+	 * @returns the status code of the last update (SMART_NODATA if there was none and update is unchanged)
 	 *
 	 */
 	inline Smart::StatusCode getUpdate(InputType &update) const {
 		// get a copy of the last update
-		update = lastUpdate;
-		return updateStatus;
+		Smart::StatusCode status = SMART_NODATA;
+		lastUpdate.readWith([&update, &status](const UpdateEntry &entry) {
+			update = entry.input;
+			status = entry.status;
+		});
+		return status;
 	}
 };
 
@@ -0,0 +1,216 @@
+//===================================================================================
+//
+//  Copyright (C) 2017 Alex Lotz, Dennis Stampfer, Matthias Lutz, Christian Schlegel
+//
+//        lotz@hs-ulm.de
+//        stampfer@hs-ulm.de
+//        lutz@hs-ulm.de
+//        schlegel@hs-ulm.de
+//
+//        Servicerobotik Ulm
+//        Christian Schlegel
+//        Ulm University of Applied Sciences
+//        Prittwitzstr. 10
+//        89075 Ulm
+//        Germany
+//
+//  This file is part of the SmartSoft Component-Developer C++ API.
+//
+//  Redistribution and use in source and binary forms, with or without modification,
+//  are permitted provided that the following conditions are met:
+//
+//  1. Redistributions of source code must retain the above copyright notice,
+//     this list of conditions and the following disclaimer.
+//
+//  2. Redistributions in binary form must reproduce the above copyright notice,
+//     this list of conditions and the following disclaimer in the documentation
+//     and/or other materials provided with the distribution.
+//
+//  3. Neither the name of the copyright holder nor the names of its contributors
+//     may be used to endorse or promote products derived from this software
+//     without specific prior written permission.
+//
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+//  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+//  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+//  IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+//  INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+//  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+//  DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+//  LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE
+//  OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+//  OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+//===================================================================================
+
+#ifndef SMARTSOFT_INTERFACES_SMARTLATESTVALUEBUFFER_T_H_
+#define SMARTSOFT_INTERFACES_SMARTLATESTVALUEBUFFER_T_H_
+
+#include <deque>
+#include <cstddef>
+#include <cstdint>
+#include <cassert>
+
+// C++11 includes
+#include <atomic>
+
+namespace Smart {
+
+/** A lock-free buffer for the latest value of a single writer and several concurrent readers
+ *
+ *  The buffer consists of a small pool of slots: the slot of the latest value and the slots that
+ *  are currently pinned by readers copying a value. The writer copy-assigns a new value into a
+ *  slot that is neither the latest one nor pinned by a reader, and then publishes it atomically.
+ *  A reader pins the latest slot while it copies the value. Therefore:
+ *
+ *    - the writer never waits for readers and readers never wait for the writer or each other
+ *      (a reader only retries if the latest slot changed between reading it and pinning it)
+ *    - readers always get a consistent value, also for types that are not trivially copyable
+ *      (e.g. containing vectors), in contrast to a seqlock
+ *    - like in the RingBuffer, slots are recycled, i.e. the heap memory owned by the values is
+ *      reused and a writer in steady state runs without allocations
+ *    - no update is ever dropped: if all slots are in use, the writer adds a new slot. Since each
+ *      reader pins at most one slot, the pool never exceeds the number of concurrent readers plus
+ *      two, and the writer always prefers the first free slot, so without contention only two
+ *      copies of the value are kept
+ *
+ *  There must be a single writer at a time: users with several writing threads (e.g. several
+ *  upcall threads of a middleware) have to serialize write() and writeWith() themselves. Concurrent
+ *  writers are detected by an assertion in debug builds.
+ *
+ *  The element type needs to be default constructible and copy assignable.
+ */
+template <class T>
+class LatestValueBuffer {
+private:
+	struct Slot {
+		T value;
+		uint64_t sequence;
+		std::atomic<unsigned int> readers;
+
+		Slot()
+		:	sequence(0)
+		,	readers(0)
+		{  }
+	};
+
+	// the slot pool is only accessed by the writer (a deque keeps the slots in place when it grows)
+	std::deque<Slot> slots;
+	// the slot with the latest value (0 while empty)
+	std::atomic<Slot*> latest;
+	std::atomic<uint64_t> latest_sequence;
+	// the writer state
+	uint64_t write_sequence;
+	// set while a writer is active (only checked in debug builds)
+	std::atomic<bool> writer_active;
+
+	LatestValueBuffer(const LatestValueBuffer&);
+	LatestValueBuffer& operator=(const LatestValueBuffer&);
+
+	// returns the first slot that is neither the latest one nor pinned by a reader (adds a slot if there is none)
+	Slot* free_slot() {
+		const Slot *current = latest.load(std::memory_order_relaxed);
+		for(typename std::deque<Slot>::iterator it=slots.begin(); it!=slots.end(); ++it) {
+			// a reader that pins the slot afterwards sees the changed latest slot and retries
+			if(&(*it) != current && it->readers.load() == 0) return &(*it);
+		}
+		slots.emplace_back();
+		return &slots.back();
+	}
+
+public:
+	/// Default constructor (preallocates the two slots needed without concurrent readers)
+	LatestValueBuffer()
+	:	slots(2)
+	,	latest(0)
+	,	latest_sequence(0)
+	,	write_sequence(0)
+	,	writer_active(false)
+	{  }
+
+	/** Publishes a new value that is written by the given writer directly into a free slot
+	 *  (must not be called concurrently, i.e. there is only one writer)
+	 *
+	 *  The slot usually still contains an older value, so the writer can reuse its memory.
+	 *
+	 *  @param writer a function object with the signature void(T&) that overwrites the value
+	 *
+	 *  @return the sequence number of the new value (counting from 1)
+	 */
+	template <class Writer>
+	uint64_t writeWith(Writer writer) {
+#ifndef NDEBUG
+		const bool concurrent_writer = writer_active.exchange(true);
+		assert(concurrent_writer == false && "LatestValueBuffer supports a single writer only");
+#endif
+		Slot *slot = this->free_slot();
+		writer(slot->value);
+		slot->sequence = ++write_sequence;
+		latest.store(slot);
+		latest_sequence.store(write_sequence);
+#ifndef NDEBUG
+		writer_active.store(false);
+#endif
+		return write_sequence;
+	}
+
+	/** Publishes a copy of a new value (must not be called concurrently, i.e. there is only one writer)
+	 *
+	 *  @param value the new value
+	 *
+	 *  @return the sequence number of the new value (counting from 1)
+	 */
+	inline uint64_t write(const T &value) {
+		return this->writeWith([&value](T &slot_value) { slot_value = value; });
+	}
+
+	/** Calls the given reader with the latest value (can be called concurrently by several readers)
+	 *
+	 *  The slot stays pinned while the reader is executed, so the reader should only copy the
+	 *  parts of the value it needs.
+	 *
+	 *  @param reader a function object with the signature void(const T&) (not called if the buffer is empty)
+	 *
+	 *  @return the sequence number of the value (counting from 1) or 0 if no value has been written yet
+	 */
+	template <class Reader>
+	uint64_t readWith(Reader reader) const {
+		while(true) {
+			Slot *slot = latest.load();
+			if(slot == 0) return 0;
+			slot->readers.fetch_add(1);
+			if(latest.load() == slot) {
+				reader(static_cast<const T&>(slot->value));
+				const uint64_t sequence = slot->sequence;
+				slot->readers.fetch_sub(1);
+				return sequence;
+			}
+			// the slot has been replaced in the meantime (and might be overwritten)
+			slot->readers.fetch_sub(1);
+		}
+	}
+
+	/** Copies the latest value (can be called concurrently by several readers)
+	 *
+	 *  @param value is set to the latest value (unchanged if the buffer is empty)
+	 *
+	 *  @return the sequence number of the value (counting from 1) or 0 if no value has been written yet
+	 */
+	inline uint64_t read(T &value) const {
+		return this->readWith([&value](const T &latest_value) { value = latest_value; });
+	}
+
+	/// returns the sequence number of the latest value (0 if no value has been written yet)
+	inline uint64_t getSequence() const {
+		return latest_sequence.load();
+	}
+
+	/// returns true if no value has been written yet
+	inline bool isEmpty() const {
+		return latest.load() == 0;
+	}
+};
+
+} /* namespace Smart */
+
+#endif /* SMARTSOFT_INTERFACES_SMARTLATESTVALUEBUFFER_T_H_ */
@@ -0,0 +1,302 @@
+//===================================================================================
+//
+//  Copyright (C) 2017 Alex Lotz, Dennis Stampfer, Matthias Lutz, Christian Schlegel
+//
+//        lotz@hs-ulm.de
+//        stampfer@hs-ulm.de
+//        lutz@hs-ulm.de
+//        schlegel@hs-ulm.de
+//
+//        Servicerobotik Ulm
+//        Christian Schlegel
+//        Ulm University of Applied Sciences
+//        Prittwitzstr. 10
+//        89075 Ulm
+//        Germany
+//
+//  This file is part of the SmartSoft Component-Developer C++ API.
+//
+//  Redistribution and use in source and binary forms, with or without modification,
+//  are permitted provided that the following conditions are met:
+//
+//  1. Redistributions of source code must retain the above copyright notice,
+//     this list of conditions and the following disclaimer.
+//
+//  2. Redistributions in binary form must reproduce the above copyright notice,
+//     this list of conditions and the following disclaimer in the documentation
+//     and/or other materials provided with the distribution.
+//
+//  3. Neither the name of the copyright holder nor the names of its contributors
+//     may be used to endorse or promote products derived from this software
+//     without specific prior written permission.
+//
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+//  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+//  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+//  IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+//  INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+//  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+//  DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+//  LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE
+//  OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+//  OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+//===================================================================================
+
+#ifndef SMARTSOFT_INTERFACES_SMARTMULTIRATETASKTRIGGER_H_
+#define SMARTSOFT_INTERFACES_SMARTMULTIRATETASKTRIGGER_H_
+
+#include <vector>
+#include <algorithm>
+
+// C++11 includes
+#include <chrono>
+#include <mutex>
+
+#include "smartITimerManager.h"
+#include "smartIVirtualClock.h"
+#include "smartTimedTaskTrigger.h"
+
+namespace Smart {
+
+/** A TimedTaskTrigger that drives several harmonic rates from a single base timer
+ *
+ *  Each observer is triggered every <i>prescaleFactor</i> base ticks (see TaskTriggerSubject::attach()).
+ *  In contrast to the plain TimedTaskTrigger, the prescaling is derived from a common tick counter,
+ *  so all rates stay phase-locked (e.g. a 1 kHz base tick with factors 1, 10 and 100 triggers the
+ *  1 kHz, 100 Hz and 10 Hz observers together at every 100th tick). Within a tick the observers are
+ *  signalled in rate-monotonic order (smallest prescale factor first), observers with the same
+ *  factor in the order of their attachment.
+ *
+ *  The trigger reports two kinds of overruns:
+ *  - a tick overrun of an observer, if the observer is due again before it finished its previous
+ *    trigger cycle (i.e. before it returned into TaskTriggerObserver::waitOnTrigger())
+ *  - missed ticks, if the base timer expired so late that whole base periods were skipped
+ *    (the tick counter advances by the skipped ticks to keep the rates phase-locked)
+ *
+ *  An observer whose due tick falls within skipped ticks is signalled (once) with the next
+ *  executed tick and counted as late (see getLateCount()), so no rate loses its cycle.
+ */
+class MultiRateTaskTrigger : public TimedTaskTrigger {
+private:
+	struct RateEntry {
+		TaskTriggerObserver *observer;
+		unsigned int prescaleFactor;
+		unsigned long sequence;
+		unsigned long overruns;
+		unsigned long late;
+	};
+
+	static inline bool rateMonotonic(const RateEntry &a, const RateEntry &b) {
+		if(a.prescaleFactor != b.prescaleFactor) return a.prescaleFactor < b.prescaleFactor;
+		return a.sequence < b.sequence;
+	}
+
+	std::mutex rate_mutex;
+	// the observers in rate-monotonic order
+	std::vector<RateEntry> rates;
+	unsigned long next_sequence;
+
+	std::chrono::steady_clock::duration base_period;
+	IVirtualClock *virtual_clock;
+	unsigned long long tick_count;
+	bool has_last_tick;
+	std::chrono::steady_clock::time_point last_tick_time;
+	unsigned long missed_ticks;
+	unsigned long overrun_count;
+	unsigned long late_count;
+
+	ITimerManager *timer_manager;
+	ITimerManager::TimerId timer_id;
+
+	inline std::chrono::steady_clock::time_point now() const {
+		return (virtual_clock != 0)? virtual_clock->now() : std::chrono::steady_clock::now();
+	}
+
+	inline std::vector<RateEntry>::iterator findEntry(const TaskTriggerObserver *observer) {
+		for(auto it=rates.begin(); it!=rates.end(); it++) {
+			if(it->observer == observer) return it;
+		}
+		return rates.end();
+	}
+
+protected:
+	virtual void timerExpired(const std::chrono::system_clock::time_point &) {
+		std::unique_lock<std::mutex> lock(rate_mutex);
+		const std::chrono::steady_clock::time_point current = this->now();
+		unsigned long long ticks = 1;
+		if(has_last_tick == true && current > last_tick_time) {
+			// round to the nearest number of base periods to tolerate the expiry jitter
+			ticks = static_cast<unsigned long long>((current - last_tick_time + base_period / 2) / base_period);
+			if(ticks > 1) {
+				missed_ticks += static_cast<unsigned long>(ticks - 1);
+			} else {
+				ticks = 1;
+			}
+		}
+		has_last_tick = true;
+		last_tick_time = current;
+		const unsigned long long previous_tick = tick_count;
+		tick_count += ticks;
+
+		for(auto it=rates.begin(); it!=rates.end(); it++) {
+			// due if a multiple of the prescale factor lies within (previous_tick, tick_count]
+			if(tick_count / it->prescaleFactor > previous_tick / it->prescaleFactor) {
+				if(tick_count % it->prescaleFactor != 0) {
+					// the due tick has been skipped
+					it->late++;
+					late_count++;
+				}
+				if(this->signal_observer(it->observer) == true) {
+					it->overruns++;
+					overrun_count++;
+					this->on_tick_overrun(it->observer, tick_count);
+				}
+			}
+		}
+	}
+
+	/** user hook that is called when an observer is due again before it finished its previous cycle
+	 *
+	 *  This hook is called from within the timer upcall while the internal lock is held,
+	 *  thus observers must not be attached or detached from within this hook.
+	 *
+	 *  @param observer the overrunning observer
+	 *  @param tick the current tick count
+	 */
+	virtual void on_tick_overrun(TaskTriggerObserver *, const unsigned long long &) {  }
+
+public:
+	/** Default constructor
+	 *
+	 *  @param base_period the period of the base tick
+	 */
+	MultiRateTaskTrigger(const std::chrono::steady_clock::duration &base_period=std::chrono::milliseconds(1))
+	:	next_sequence(0)
+	,	base_period(base_period)
+	,	virtual_clock(IVirtualClock::getProcessClock())
+	,	tick_count(0)
+	,	has_last_tick(false)
+	,	missed_ticks(0)
+	,	overrun_count(0)
+	,	late_count(0)
+	,	timer_manager(0)
+	,	timer_id(-1)
+	{  }
+
+	/// Default destructor (stops the base timer)
+	virtual ~MultiRateTaskTrigger()
+	{
+		this->stop();
+	}
+
+	virtual void attach(TaskTriggerObserver *observer, const unsigned int &prescaleFactor=1) {
+		std::unique_lock<std::mutex> lock(rate_mutex);
+		TaskTriggerSubject::attach(observer, prescaleFactor);
+		auto it = this->findEntry(observer);
+		if(it != rates.end()) rates.erase(it);
+		RateEntry entry;
+		entry.observer = observer;
+		entry.prescaleFactor = (prescaleFactor > 0)? prescaleFactor : 1;
+		entry.sequence = next_sequence++;
+		entry.overruns = 0;
+		entry.late = 0;
+		rates.insert(std::upper_bound(rates.begin(), rates.end(), entry, &MultiRateTaskTrigger::rateMonotonic), entry);
+	}
+
+	virtual void detach(TaskTriggerObserver *observer) {
+		std::unique_lock<std::mutex> lock(rate_mutex);
+		TaskTriggerSubject::detach(observer);
+		auto it = this->findEntry(observer);
+		if(it != rates.end()) rates.erase(it);
+	}
+
+	virtual void setPrescaleFactor(TaskTriggerObserver *observer, const unsigned int &prescaleFactor) {
+		std::unique_lock<std::mutex> lock(rate_mutex);
+		TaskTriggerSubject::setPrescaleFactor(observer, prescaleFactor);
+		auto it = this->findEntry(observer);
+		if(it != rates.end()) {
+			it->prescaleFactor = (prescaleFactor > 0)? prescaleFactor : 1;
+			std::stable_sort(rates.begin(), rates.end(), &MultiRateTaskTrigger::rateMonotonic);
+		}
+	}
+
+	/** Schedules the base timer
+	 *
+	 *  @param timer_manager the timer manager to use
+	 *
+	 *  @return 0 on success or -1 on failure (e.g. if already started)
+	 */
+	int start(ITimerManager *timer_manager) {
+		std::unique_lock<std::mutex> lock(rate_mutex);
+		if(timer_manager == 0 || this->timer_manager != 0) return -1;
+		has_last_tick = false;
+		timer_id = timer_manager->scheduleTimer(this, base_period, base_period);
+		if(timer_id < 0) return -1;
+		this->timer_manager = timer_manager;
+		return 0;
+	}
+
+	/// cancels the base timer (and all timers scheduled by an owner, see TimedTaskTrigger::stop())
+	void stop() {
+		ITimerManager *current_manager = 0;
+		ITimerManager::TimerId current_id = -1;
+		{
+			std::unique_lock<std::mutex> lock(rate_mutex);
+			current_manager = timer_manager;
+			current_id = timer_id;
+			timer_manager = 0;
+			timer_id = -1;
+		}
+		// cancelling waits for a running upcall, which locks the rate_mutex
+		if(current_manager != 0) current_manager->cancelTimer(current_id);
+		TimedTaskTrigger::stop();
+	}
+
+	/// returns the period of the base tick
+	std::chrono::steady_clock::duration getBasePeriod() const {
+		return base_period;
+	}
+
+	/// returns the number of base ticks (including missed ticks) since the construction
+	unsigned long long getTickCount() {
+		std::unique_lock<std::mutex> lock(rate_mutex);
+		return tick_count;
+	}
+
+	/// returns the number of skipped base ticks
+	unsigned long getMissedTicks() {
+		std::unique_lock<std::mutex> lock(rate_mutex);
+		return missed_ticks;
+	}
+
+	/// returns the total number of tick overruns of all observers
+	unsigned long getOverrunCount() {
+		std::unique_lock<std::mutex> lock(rate_mutex);
+		return overrun_count;
+	}
+
+	/// returns the number of tick overruns of a single observer
+	unsigned long getOverrunCount(const TaskTriggerObserver *observer) {
+		std::unique_lock<std::mutex> lock(rate_mutex);
+		auto it = this->findEntry(observer);
+		return (it != rates.end())? it->overruns : 0;
+	}
+
+	/// returns the total number of late triggers (whose due tick has been skipped) of all observers
+	unsigned long getLateCount() {
+		std::unique_lock<std::mutex> lock(rate_mutex);
+		return late_count;
+	}
+
+	/// returns the number of late triggers (whose due tick has been skipped) of a single observer
+	unsigned long getLateCount(const TaskTriggerObserver *observer) {
+		std::unique_lock<std::mutex> lock(rate_mutex);
+		auto it = this->findEntry(observer);
+		return (it != rates.end())? it->late : 0;
+	}
+};
+
+} /* namespace Smart */
+
+#endif /* SMARTSOFT_INTERFACES_SMARTMULTIRATETASKTRIGGER_H_ */
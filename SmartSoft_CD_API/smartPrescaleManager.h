@@ -76,6 +76,17 @@ public:
 			return false;
 		}
 	}
+
+	// returns the current prescale factor
+	inline unsigned int getPrescaleFactor() const {
+		return prescaleFactor;
+	}
+
+	// sets a new prescale factor and restarts the update counting
+	inline void setPrescaleFactor(const unsigned int &prescaleFactor) {
+		this->prescaleFactor = prescaleFactor;
+		this->updateCounter = 1;
+	}
 };
 
 } /* namespace Smart */
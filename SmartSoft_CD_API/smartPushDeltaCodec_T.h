@@ -0,0 +1,261 @@
+//===================================================================================
+//
+//  Copyright (C) 2017 Alex Lotz, Dennis Stampfer, Matthias Lutz, Christian Schlegel
+//
+//        lotz@hs-ulm.de
+//        stampfer@hs-ulm.de
+//        lutz@hs-ulm.de
+//        schlegel@hs-ulm.de
+//
+//        Servicerobotik Ulm
+//        Christian Schlegel
+//        Ulm University of Applied Sciences
+//        Prittwitzstr. 10
+//        89075 Ulm
+//        Germany
+//
+//  This file is part of the SmartSoft Component-Developer C++ API.
+//
+//  Redistribution and use in source and binary forms, with or without modification,
+//  are permitted provided that the following conditions are met:
+//
+//  1. Redistributions of source code must retain the above copyright notice,
+//     this list of conditions and the following disclaimer.
+//
+//  2. Redistributions in binary form must reproduce the above copyright notice,
+//     this list of conditions and the following disclaimer in the documentation
+//     and/or other materials provided with the distribution.
+//
+//  3. Neither the name of the copyright holder nor the names of its contributors
+//     may be used to endorse or promote products derived from this software
+//     without specific prior written permission.
+//
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+//  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+//  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+//  IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+//  INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+//  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+//  DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+//  LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE
+//  OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+//  OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+//===================================================================================
+
+#ifndef SMARTSOFT_INTERFACES_SMARTPUSHDELTACODEC_T_H_
+#define SMARTSOFT_INTERFACES_SMARTPUSHDELTACODEC_T_H_
+
+#include <cstdint>
+
+// C++11 includes
+#include <memory>
+#include <mutex>
+
+#include "smartStatusCode.h"
+#include "smartPushDeltaTraits_T.h"
+
+namespace Smart {
+
+/** Creates the frames of the delta mode at the push server (thread safe)
+ *
+ *  encode() is called once per IPushServerPattern::put() and decides, based on the keyframe
+ *  interval and PushDeltaTraits::diff(), whether the update becomes a keyframe or a delta.
+ *  The send path of each subscriber then calls getFrame() with the sequence number of the
+ *  latest keyframe the subscriber has received (initially 0). Deltas refer to the latest
+ *  keyframe (not to the previous update), so subscribers with a prescale factor or with lost
+ *  updates can still decode them. Subscribers that missed the latest keyframe get a resync
+ *  frame (the keyframe and the latest delta) once and the deltas afterwards. The returned frames are immutable and shared by all
+ *  subscribers (e.g. within a SharedPushUpdate to serialize each frame at most once).
+ *
+ *  Template parameters
+ *    - <b>DataType</b>: Pushed value class (Communication Object)
+ */
+template<class DataType>
+class PushDeltaEncoder {
+public:
+	typedef PushDeltaFrame<DataType> FrameType;
+
+private:
+	std::mutex encoder_mutex;
+	unsigned int keyframe_interval;
+	unsigned int updates_since_keyframe;
+	std::shared_ptr<const FrameType> keyframe;
+	std::shared_ptr<const FrameType> current_frame;
+	// the resync frame of current_frame (created on demand)
+	std::shared_ptr<const FrameType> resync_frame;
+	unsigned long keyframes;
+	unsigned long deltas;
+
+public:
+	/** Default constructor
+	 *
+	 *  @param keyframeInterval every keyframeInterval-th update is sent as keyframe (0 and 1 disable the delta mode)
+	 */
+	PushDeltaEncoder(const unsigned int &keyframeInterval=0)
+	:	keyframe_interval(keyframeInterval)
+	,	updates_since_keyframe(0)
+	,	keyframes(0)
+	,	deltas(0)
+	{  }
+
+	/** Changes the keyframe interval (the next update is sent as keyframe)
+	 */
+	void setKeyframeInterval(const unsigned int &keyframeInterval) {
+		std::unique_lock<std::mutex> lock(encoder_mutex);
+		keyframe_interval = keyframeInterval;
+		updates_since_keyframe = 0;
+	}
+
+	unsigned int getKeyframeInterval() {
+		std::unique_lock<std::mutex> lock(encoder_mutex);
+		return keyframe_interval;
+	}
+
+	/** Encodes a new update
+	 *
+	 *  @param d        the new update (shared, no copy is made)
+	 *  @param sequence the sequence number of the update (see IPushServerPattern::prepare_update())
+	 */
+	void encode(const std::shared_ptr<const DataType> &d, const uint64_t &sequence) {
+		std::shared_ptr<FrameType> frame = std::make_shared<FrameType>();
+		frame->sequence = sequence;
+
+		std::unique_lock<std::mutex> lock(encoder_mutex);
+		// the diff is computed under the lock, so the frames refer to the keyframe in put() order
+		const bool use_delta = keyframe_interval > 1 && keyframe
+			&& updates_since_keyframe < keyframe_interval
+			&& PushDeltaTraits<DataType>::diff(*keyframe->data, *d, frame->delta);
+		if(use_delta) {
+			frame->keyframeSequence = keyframe->sequence;
+			updates_since_keyframe++;
+			deltas++;
+		} else {
+			frame->keyframeSequence = sequence;
+			frame->data = d;
+			frame->delta = typename FrameType::DeltaType();
+			keyframe = frame;
+			updates_since_keyframe = 1;
+			keyframes++;
+		}
+		current_frame = frame;
+		resync_frame.reset();
+	}
+
+	/** Returns the frame of the latest update for a subscriber
+	 *
+	 *  @param subscriberKeyframe the sequence number of the latest keyframe the subscriber has received
+	 *                            (0 initially), which is updated if a keyframe is returned
+	 *
+	 *  @return the latest delta if the subscriber has its keyframe, otherwise a keyframe
+	 *          or resync frame (empty if nothing has been encoded yet)
+	 */
+	std::shared_ptr<const FrameType> getFrame(uint64_t &subscriberKeyframe) {
+		std::unique_lock<std::mutex> lock(encoder_mutex);
+		if(!current_frame) return current_frame;
+		if(current_frame->isKeyframe()) {
+			subscriberKeyframe = current_frame->sequence;
+			return current_frame;
+		}
+		if(current_frame->keyframeSequence == subscriberKeyframe) {
+			return current_frame;
+		}
+		if(!resync_frame) {
+			// the keyframe is sent along with the delta, so the next deltas are decodable
+			std::shared_ptr<FrameType> frame = std::make_shared<FrameType>();
+			frame->sequence = current_frame->sequence;
+			frame->keyframeSequence = current_frame->keyframeSequence;
+			frame->data = keyframe->data;
+			frame->delta = current_frame->delta;
+			resync_frame = frame;
+		}
+		subscriberKeyframe = current_frame->keyframeSequence;
+		return resync_frame;
+	}
+
+	/// returns the number of updates encoded as keyframe
+	unsigned long getKeyframes() {
+		std::unique_lock<std::mutex> lock(encoder_mutex);
+		return keyframes;
+	}
+
+	/// returns the number of updates encoded as delta
+	unsigned long getDeltas() {
+		std::unique_lock<std::mutex> lock(encoder_mutex);
+		return deltas;
+	}
+};
+
+/** Reconstructs the updates of the delta mode at the push client
+ *
+ *  The decoder keeps the latest received keyframe and is used by the receive path of an
+ *  IPushClientPattern implementation before the update is stored for getUpdate() and
+ *  delivered to the handlers (it is not thread safe).
+ *
+ *  Template parameters
+ *    - <b>DataType</b>: Pushed value class (Communication Object)
+ */
+template<class DataType>
+class PushDeltaDecoder {
+public:
+	typedef PushDeltaFrame<DataType> FrameType;
+
+private:
+	std::shared_ptr<const DataType> keyframe;
+	uint64_t keyframe_sequence;
+	unsigned long undecodable_frames;
+
+public:
+	PushDeltaDecoder()
+	:	keyframe_sequence(0)
+	,	undecodable_frames(0)
+	{  }
+
+	/** Reconstructs the update of a frame
+	 *
+	 *  @param frame the received frame
+	 *  @param d     is set to the reconstructed update
+	 *
+	 *  @return status code
+	 *    - SMART_OK     : the update has been reconstructed
+	 *    - SMART_NODATA : the frame is a delta for a keyframe that has not been received
+	 *                     (the next keyframe or resync frame will be decodable again)
+	 *    - SMART_ERROR  : PushDeltaTraits::patch() failed
+	 */
+	StatusCode decode(const FrameType &frame, DataType &d) {
+		if(frame.data) {
+			// keyframes and resync frames contain the keyframe for the subsequent deltas
+			keyframe = frame.data;
+			keyframe_sequence = frame.keyframeSequence;
+			if(frame.isKeyframe()) {
+				d = *frame.data;
+				return SMART_OK;
+			}
+		}
+		if(!keyframe || frame.keyframeSequence != keyframe_sequence) {
+			undecodable_frames++;
+			return SMART_NODATA;
+		}
+		d = *keyframe;
+		if(!PushDeltaTraits<DataType>::patch(d, frame.delta)) {
+			undecodable_frames++;
+			return SMART_ERROR;
+		}
+		return SMART_OK;
+	}
+
+	/// discards the keyframe (e.g. when subscribing again)
+	void reset() {
+		keyframe.reset();
+		keyframe_sequence = 0;
+	}
+
+	/// returns the number of frames that could not be decoded
+	unsigned long getUndecodableFrames() const {
+		return undecodable_frames;
+	}
+};
+
+} /* namespace Smart */
+
+#endif /* SMARTSOFT_INTERFACES_SMARTPUSHDELTACODEC_T_H_ */
@@ -0,0 +1,148 @@
+//===================================================================================
+//
+//  Copyright (C) 2017 Alex Lotz, Dennis Stampfer, Matthias Lutz, Christian Schlegel
+//
+//        lotz@hs-ulm.de
+//        stampfer@hs-ulm.de
+//        lutz@hs-ulm.de
+//        schlegel@hs-ulm.de
+//
+//        Servicerobotik Ulm
+//        Christian Schlegel
+//        Ulm University of Applied Sciences
+//        Prittwitzstr. 10
+//        89075 Ulm
+//        Germany
+//
+//  This file is part of the SmartSoft Component-Developer C++ API.
+//
+//  Redistribution and use in source and binary forms, with or without modification,
+//  are permitted provided that the following conditions are met:
+//
+//  1. Redistributions of source code must retain the above copyright notice,
+//     this list of conditions and the following disclaimer.
+//
+//  2. Redistributions in binary form must reproduce the above copyright notice,
+//     this list of conditions and the following disclaimer in the documentation
+//     and/or other materials provided with the distribution.
+//
+//  3. Neither the name of the copyright holder nor the names of its contributors
+//     may be used to endorse or promote products derived from this software
+//     without specific prior written permission.
+//
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+//  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+//  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+//  IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+//  INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+//  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+//  DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+//  LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE
+//  OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+//  OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+//===================================================================================
+
+#ifndef SMARTSOFT_INTERFACES_SMARTPUSHDELTATRAITS_T_H_
+#define SMARTSOFT_INTERFACES_SMARTPUSHDELTATRAITS_T_H_
+
+#include <cstdint>
+
+// C++11 includes
+#include <memory>
+
+namespace Smart {
+
+/** Describes how a pushed DataType is delta encoded
+ *
+ *  In delta mode (see IPushServerPattern::setKeyframeInterval()) the push server sends
+ *  keyframes (the complete data) followed by the differences of the subsequent updates to
+ *  the latest keyframe. The default implementation does not support deltas, so each update
+ *  is sent as keyframe. Communication objects that change slowly (e.g. occupancy grids or
+ *  parameter tables) specialize this template:
+ *
+ *  <pre>
+ *  namespace Smart {
+ *  template<> struct PushDeltaTraits<MyGrid> {
+ *      typedef MyGridCellChanges DeltaType;
+ *      static bool diff(const MyGrid &keyframe, const MyGrid &current, DeltaType &delta) {
+ *          return keyframe.sameSize(current) && current.changedCells(keyframe, delta);
+ *      }
+ *      static bool patch(MyGrid &data, const DeltaType &delta) { return data.applyCells(delta); }
+ *  };
+ *  }
+ *  </pre>
+ */
+template<class DataType>
+struct PushDeltaTraits {
+	/// the difference between two updates (a communication object itself)
+	typedef DataType DeltaType;
+
+	/** Computes the difference of an update to a keyframe
+	 *
+	 *  @param keyframe the latest keyframe
+	 *  @param current  the new update
+	 *  @param delta    is set to the difference (default constructed before)
+	 *
+	 *  @return false if the update has to be sent as keyframe (e.g. because the delta is too large)
+	 */
+	static bool diff(const DataType &, const DataType &, DeltaType &) {
+		return false;
+	}
+
+	/** Applies a difference to a copy of the keyframe it has been computed for
+	 *
+	 *  @param data  the keyframe, which is changed to the update
+	 *  @param delta the difference computed by diff()
+	 *
+	 *  @return false if the delta could not be applied
+	 */
+	static bool patch(DataType &, const DeltaType &) {
+		return false;
+	}
+};
+
+/** A push update in delta mode as sent by the server
+ *
+ *  There are three kinds of frames:
+ *    - keyframes contain the complete data and are the reference for subsequent deltas
+ *    - deltas contain the difference to the keyframe with the sequence number keyframeSequence
+ *    - resync frames contain both the keyframe keyframeSequence and the difference to it, they
+ *      are sent to subscribers that do not have the latest keyframe (e.g. late joiners or
+ *      subscribers whose prescale factor skipped the keyframe), which then decode the
+ *      subsequent deltas again
+ */
+template<class DataType>
+struct PushDeltaFrame {
+	typedef typename PushDeltaTraits<DataType>::DeltaType DeltaType;
+
+	/// the sequence number of this update (see PushUpdateInfo)
+	uint64_t sequence;
+	/// the sequence number of the keyframe the update refers to (equals sequence for keyframes)
+	uint64_t keyframeSequence;
+	/// the complete data of the keyframe keyframeSequence (empty for deltas)
+	std::shared_ptr<const DataType> data;
+	/// the difference to the keyframe (only for deltas and resync frames)
+	DeltaType delta;
+
+	PushDeltaFrame()
+	:	sequence(0)
+	,	keyframeSequence(0)
+	{  }
+
+	inline bool isKeyframe() const {
+		return data && sequence == keyframeSequence;
+	}
+
+	inline bool isDelta() const {
+		return !data;
+	}
+
+	inline bool isResync() const {
+		return data && sequence != keyframeSequence;
+	}
+};
+
+} /* namespace Smart */
+
+#endif /* SMARTSOFT_INTERFACES_SMARTPUSHDELTATRAITS_T_H_ */
@@ -0,0 +1,204 @@
+//===================================================================================
+//
+//  Copyright (C) 2017 Alex Lotz, Dennis Stampfer, Matthias Lutz, Christian Schlegel
+//
+//        lotz@hs-ulm.de
+//        stampfer@hs-ulm.de
+//        lutz@hs-ulm.de
+//        schlegel@hs-ulm.de
+//
+//        Servicerobotik Ulm
+//        Christian Schlegel
+//        Ulm University of Applied Sciences
+//        Prittwitzstr. 10
+//        89075 Ulm
+//        Germany
+//
+//  This file is part of the SmartSoft Component-Developer C++ API.
+//
+//  Redistribution and use in source and binary forms, with or without modification,
+//  are permitted provided that the following conditions are met:
+//
+//  1. Redistributions of source code must retain the above copyright notice,
+//     this list of conditions and the following disclaimer.
+//
+//  2. Redistributions in binary form must reproduce the above copyright notice,
+//     this list of conditions and the following disclaimer in the documentation
+//     and/or other materials provided with the distribution.
+//
+//  3. Neither the name of the copyright holder nor the names of its contributors
+//     may be used to endorse or promote products derived from this software
+//     without specific prior written permission.
+//
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+//  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+//  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+//  IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+//  INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+//  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+//  DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+//  LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE
+//  OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+//  OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+//===================================================================================
+
+#ifndef SMARTSOFT_INTERFACES_SMARTPUSHUPDATEHISTORY_T_H_
+#define SMARTSOFT_INTERFACES_SMARTPUSHUPDATEHISTORY_T_H_
+
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+
+// C++11 includes
+#include <chrono>
+#include <mutex>
+
+#include "smartStatusCode.h"
+#include "smartRingBuffer_T.h"
+
+namespace Smart {
+
+/// the meta data the push server attaches to each update
+struct PushUpdateInfo {
+	/// the number of the update at the server (counting from 1 with each put(), also for updates a client does not receive)
+	uint64_t sequence;
+	/// the time at which the server published the update
+	std::chrono::system_clock::time_point timestamp;
+
+	PushUpdateInfo()
+	:	sequence(0)
+	{  }
+
+	PushUpdateInfo(const uint64_t &sequence, const std::chrono::system_clock::time_point &timestamp)
+	:	sequence(sequence)
+	,	timestamp(timestamp)
+	{  }
+};
+
+/** The bounded history of the push updates received by a client (thread safe)
+ *
+ *  The history keeps the last N updates together with their PushUpdateInfo in a RingBuffer
+ *  (the slots and the memory of the updates are recycled). It detects gaps in the received
+ *  sequence numbers: with a prescale factor of n, the sequence number of each update is
+ *  expected to be n higher than the one of the previous update.
+ *
+ *  Template parameters
+ *    - <b>DataType</b>: Pushed value class (Communication Object)
+ */
+template <class DataType>
+class PushUpdateHistory {
+private:
+	struct HistoryEntry {
+		PushUpdateInfo info;
+		DataType data;
+	};
+
+	std::mutex history_mutex;
+	RingBuffer<HistoryEntry> updates;
+	std::size_t depth;
+	uint64_t prescale;
+	uint64_t latest_sequence;
+	unsigned long missed_updates;
+
+public:
+	/** Default constructor
+	 *
+	 *  @param depth the number of updates to keep (0 disables the history)
+	 */
+	PushUpdateHistory(const std::size_t &depth=0)
+	:	updates(depth)
+	,	depth(depth)
+	,	prescale(1)
+	,	latest_sequence(0)
+	,	missed_updates(0)
+	{  }
+
+	/** Changes the number of kept updates (the kept updates are discarded)
+	 */
+	void setDepth(const std::size_t &depth) {
+		std::unique_lock<std::mutex> lock(history_mutex);
+		updates.clear();
+		updates.resize(depth);
+		this->depth = depth;
+	}
+
+	/** Discards all updates and restarts the gap detection (e.g. with a new subscription)
+	 *
+	 *  @param prescale the prescale factor of the subscription
+	 */
+	void reset(const int &prescale=1) {
+		std::unique_lock<std::mutex> lock(history_mutex);
+		updates.clear();
+		this->prescale = (prescale > 0)? prescale : 1;
+		latest_sequence = 0;
+	}
+
+	/** Adds a received update (and drops the oldest update if the history is full)
+	 *
+	 *  An update whose sequence number is not higher than the latest one (e.g. after a restart
+	 *  of the server) discards the kept updates and restarts the gap detection, so the history
+	 *  always stays in ascending order.
+	 */
+	void record(const DataType &data, const PushUpdateInfo &info) {
+		std::unique_lock<std::mutex> lock(history_mutex);
+		if(latest_sequence > 0 && info.sequence <= latest_sequence) {
+			updates.clear();
+		} else if(latest_sequence > 0 && info.sequence > latest_sequence + prescale) {
+			missed_updates += (info.sequence - latest_sequence) / prescale - 1;
+		}
+		latest_sequence = info.sequence;
+		if(depth == 0) return;
+		if(updates.isFull()) updates.popFront();
+		HistoryEntry *entry = updates.pushSlot();
+		entry->info = info;
+		entry->data = data;
+	}
+
+	/** Copies all kept updates with a sequence number higher than the given one
+	 *
+	 *  If the returned updates do not start with sequence + prescale, updates are missing
+	 *  (either evicted from the history or lost on the way, see getMissedUpdates()). If
+	 *  getLatestSequence() is lower than the caller's sequence number, the sequence has been
+	 *  restarted (see record()) and the caller should ask for all kept updates again.
+	 *
+	 *  @param sequence the sequence number of the latest update known to the caller (0 for all kept updates)
+	 *  @param updates  is set to the newer updates in ascending order (the elements are reused)
+	 *
+	 *  @return status code
+	 *    - SMART_OK     : at least one newer update has been returned
+	 *    - SMART_NODATA : there is no newer update
+	 */
+	StatusCode getUpdatesSince(const uint64_t &sequence, std::vector< std::pair<PushUpdateInfo,DataType> > &updates) {
+		std::unique_lock<std::mutex> lock(history_mutex);
+		std::size_t first = this->updates.size();
+		while(first > 0 && this->updates.at(first-1).info.sequence > sequence) {
+			--first;
+		}
+		const std::size_t count = this->updates.size() - first;
+		updates.resize(count);
+		for(std::size_t i=0; i<count; ++i) {
+			const HistoryEntry &entry = this->updates.at(first + i);
+			updates[i].first = entry.info;
+			updates[i].second = entry.data;
+		}
+		return (count > 0)? SMART_OK : SMART_NODATA;
+	}
+
+	/// returns the sequence number of the latest received update (0 if there was none)
+	uint64_t getLatestSequence() {
+		std::unique_lock<std::mutex> lock(history_mutex);
+		return latest_sequence;
+	}
+
+	/// returns the number of updates that have not been received (detected by gaps in the sequence numbers)
+	unsigned long getMissedUpdates() {
+		std::unique_lock<std::mutex> lock(history_mutex);
+		return missed_updates;
+	}
+};
+
+} /* namespace Smart */
+
+#endif /* SMARTSOFT_INTERFACES_SMARTPUSHUPDATEHISTORY_T_H_ */
@@ -0,0 +1,97 @@
+//===================================================================================
+//
+//  Copyright (C) 2017 Alex Lotz, Dennis Stampfer, Matthias Lutz, Christian Schlegel
+//
+//        lotz@hs-ulm.de
+//        stampfer@hs-ulm.de
+//        lutz@hs-ulm.de
+//        schlegel@hs-ulm.de
+//
+//        Servicerobotik Ulm
+//        Christian Schlegel
+//        Ulm University of Applied Sciences
+//        Prittwitzstr. 10
+//        89075 Ulm
+//        Germany
+//
+//  This file is part of the SmartSoft Component-Developer C++ API.
+//
+//  Redistribution and use in source and binary forms, with or without modification,
+//  are permitted provided that the following conditions are met:
+//
+//  1. Redistributions of source code must retain the above copyright notice,
+//     this list of conditions and the following disclaimer.
+//
+//  2. Redistributions in binary form must reproduce the above copyright notice,
+//     this list of conditions and the following disclaimer in the documentation
+//     and/or other materials provided with the distribution.
+//
+//  3. Neither the name of the copyright holder nor the names of its contributors
+//     may be used to endorse or promote products derived from this software
+//     without specific prior written permission.
+//
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+//  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+//  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+//  IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+//  INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+//  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+//  DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+//  LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE
+//  OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+//  OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+//===================================================================================
+
+#ifndef SMARTSOFT_INTERFACES_SMARTQUERYANSWERCHUNKTRAITS_T_H_
+#define SMARTSOFT_INTERFACES_SMARTQUERYANSWERCHUNKTRAITS_T_H_
+
+namespace Smart {
+
+namespace detail {
+	// appends sequence containers (selected if the insert() expression is valid)
+	template<class AnswerType>
+	inline auto appendQueryAnswerChunk(AnswerType &answer, const AnswerType &chunk, int) -> decltype(answer.insert(answer.end(), chunk.begin(), chunk.end()), bool()) {
+		answer.insert(answer.end(), chunk.begin(), chunk.end());
+		return true;
+	}
+
+	// all other types need a specialization of QueryAnswerChunkTraits
+	template<class AnswerType>
+	inline bool appendQueryAnswerChunk(AnswerType &, const AnswerType &, long) {
+		return false;
+	}
+} /* namespace detail */
+
+/** Describes how the chunks of a streamed query answer are assembled
+ *
+ *  A streamed answer (see IQueryServerPattern::answerChunk()) consists of several partial
+ *  answers of the same AnswerType that are appended to each other in order. The default
+ *  implementation appends sequence containers (e.g. std::vector or std::string); other
+ *  communication objects specialize this template:
+ *
+ *  <pre>
+ *  namespace Smart {
+ *  template<> struct QueryAnswerChunkTraits<MyMap> {
+ *      static bool append(MyMap &answer, const MyMap &chunk) { answer.appendCells(chunk); return true; }
+ *  };
+ *  }
+ *  </pre>
+ */
+template<class AnswerType>
+struct QueryAnswerChunkTraits {
+	/** Appends a chunk to the (partially) assembled answer
+	 *
+	 *  @param answer the answer assembled so far (default constructed before the first chunk)
+	 *  @param chunk  the next chunk of the answer
+	 *
+	 *  @return false if the AnswerType can not be assembled from chunks
+	 */
+	static bool append(AnswerType &answer, const AnswerType &chunk) {
+		return detail::appendQueryAnswerChunk(answer, chunk, 0);
+	}
+};
+
+} /* namespace Smart */
+
+#endif /* SMARTSOFT_INTERFACES_SMARTQUERYANSWERCHUNKTRAITS_T_H_ */
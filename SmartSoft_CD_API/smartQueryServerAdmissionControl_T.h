@@ -0,0 +1,303 @@
+//===================================================================================
+//
+//  Copyright (C) 2017 Alex Lotz, Dennis Stampfer, Matthias Lutz, Christian Schlegel
+//
+//        lotz@hs-ulm.de
+//        stampfer@hs-ulm.de
+//        lutz@hs-ulm.de
+//        schlegel@hs-ulm.de
+//
+//        Servicerobotik Ulm
+//        Christian Schlegel
+//        Ulm University of Applied Sciences
+//        Prittwitzstr. 10
+//        89075 Ulm
+//        Germany
+//
+//  This file is part of the SmartSoft Component-Developer C++ API.
+//
+//  Redistribution and use in source and binary forms, with or without modification,
+//  are permitted provided that the following conditions are met:
+//
+//  1. Redistributions of source code must retain the above copyright notice,
+//     this list of conditions and the following disclaimer.
+//
+//  2. Redistributions in binary form must reproduce the above copyright notice,
+//     this list of conditions and the following disclaimer in the documentation
+//     and/or other materials provided with the distribution.
+//
+//  3. Neither the name of the copyright holder nor the names of its contributors
+//     may be used to endorse or promote products derived from this software
+//     without specific prior written permission.
+//
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+//  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+//  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+//  IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+//  INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+//  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+//  DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+//  LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE
+//  OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+//  OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+//===================================================================================
+
+#ifndef SMARTSOFT_INTERFACES_SMARTQUERYSERVERADMISSIONCONTROL_T_H_
+#define SMARTSOFT_INTERFACES_SMARTQUERYSERVERADMISSIONCONTROL_T_H_
+
+#include <map>
+#include <cstddef>
+#include <algorithm>
+
+// C++11 includes
+#include <chrono>
+#include <mutex>
+
+#include "smartIQueryServerPattern_T.h"
+
+namespace Smart {
+
+/// the configuration of a QueryServerAdmissionControl
+struct QueryAdmissionParameters {
+	/// the maximum number of admitted requests that have not been answered yet (0 means unlimited)
+	std::size_t maxInFlight;
+	/// the acceptable latency from the arrival of a request until its answer (zero disables the latency control)
+	std::chrono::steady_clock::duration latencyTarget;
+	/// the time the latency has to stay above the target until requests are rejected
+	std::chrono::steady_clock::duration interval;
+
+	QueryAdmissionParameters()
+	:	maxInFlight(0)
+	,	latencyTarget(std::chrono::steady_clock::duration::zero())
+	,	interval(std::chrono::milliseconds(100))
+	{  }
+};
+
+/// statistics about the admission decisions of a QueryServerAdmissionControl
+struct QueryAdmissionStatistics {
+	/// the number of requests forwarded to the inner handlers
+	unsigned long admitted;
+	/// the number of requests rejected because of the maximum number of in-flight requests
+	unsigned long rejectedInFlight;
+	/// the number of requests rejected because of the latency target
+	unsigned long rejectedLatency;
+	/// the number of rejected requests (see above) that have been admitted nevertheless since the real server does not support IQueryServerPattern::rejectQuery()
+	unsigned long rejectionsUnsupported;
+	/// the current number of admitted requests that have not been answered yet
+	std::size_t inFlight;
+	/// whether the latency currently exceeds the target for longer than the interval
+	bool overloaded;
+	/// the number of in-flight requests admitted while overloaded
+	std::size_t overloadLimit;
+
+	QueryAdmissionStatistics()
+	:	admitted(0)
+	,	rejectedInFlight(0)
+	,	rejectedLatency(0)
+	,	rejectionsUnsupported(0)
+	,	inFlight(0)
+	,	overloaded(false)
+	,	overloadLimit(0)
+	{  }
+};
+
+/** Admission control between an IQueryServerPattern and its IQueryServerHandler(s)
+ *
+ *  Like the QueryServerAnswerCache, the admission control observes the real query server and
+ *  itself acts as the IQueryServerPattern for the inner handlers. Incoming requests are either
+ *  forwarded to the inner handlers or immediately rejected via IQueryServerPattern::rejectQuery()
+ *  of the real server (the client receives SMART_OVERLOADED), which bounds the latency under
+ *  overload instead of letting the backlog grow:
+ *
+ *    - a request is rejected if the maximum number of in-flight requests is reached
+ *    - the latency of each answered request (from its arrival until answer()) is compared to
+ *      the latency target. As in CoDel, the server is considered overloaded once the latency has
+ *      stayed above the target for a whole interval (so that short bursts pass), and it leaves
+ *      this state with the first answer below the target. While overloaded, the number of in-flight
+ *      requests is limited to the number that was in flight when the latest answer below the target
+ *      was sent (i.e. to the backlog the server is known to process in time, but at least one).
+ *
+ *  If the real server does not support rejections (see IQueryServerPattern::rejectQuery()),
+ *  the requests are admitted nevertheless, since their clients would wait for an answer.
+ */
+template<class RequestType, class AnswerType, class QIDType>
+class QueryServerAdmissionControl
+:	public IQueryServerHandler<RequestType,AnswerType,QIDType>
+,	public IQueryServerPattern<RequestType,AnswerType,QIDType>
+{
+private:
+	typedef std::chrono::steady_clock::time_point TimePoint;
+
+	std::mutex admission_mutex;
+	QueryAdmissionParameters parameters;
+	QueryAdmissionStatistics statistics;
+	// the arrival times of the admitted requests that have not been answered yet
+	std::map<QIDType, TimePoint> arrival_times;
+
+	// the time at which the latency has been above the target for a whole interval (max() while below the target)
+	TimePoint first_above_time;
+	// the number of requests in flight when the latest answer below the target was sent
+	std::size_t good_in_flight;
+
+	// removes an admitted request and optionally feeds its latency into the CoDel state (call with locked admission_mutex)
+	void release(const QIDType &id, const bool &answered) {
+		auto it = arrival_times.find(id);
+		if(it == arrival_times.end()) return;
+		const TimePoint now = std::chrono::steady_clock::now();
+		const std::chrono::steady_clock::duration latency = now - it->second;
+		const std::size_t in_flight = arrival_times.size();
+		arrival_times.erase(it);
+		if(!answered || parameters.latencyTarget == std::chrono::steady_clock::duration::zero()) return;
+
+		if(latency < parameters.latencyTarget) {
+			first_above_time = TimePoint::max();
+			good_in_flight = in_flight;
+			statistics.overloaded = false;
+		} else if(first_above_time == TimePoint::max()) {
+			first_above_time = now + parameters.interval;
+		} else if(now >= first_above_time) {
+			statistics.overloaded = true;
+		}
+	}
+
+protected:
+	/// the real server is responsible for the disconnect of its clients
+	virtual void serverInitiatedDisconnect()
+	{  }
+
+public:
+	/** Default constructor
+	 *
+	 *  @param server      the real query server whose requests are admitted
+	 *  @param parameters  the admission parameters
+	 */
+	QueryServerAdmissionControl(IQueryServerPattern<RequestType,AnswerType,QIDType> *server, const QueryAdmissionParameters &parameters=QueryAdmissionParameters())
+	:	IQueryServerHandler<RequestType,AnswerType,QIDType>(server)
+	,	IQueryServerPattern<RequestType,AnswerType,QIDType>(0, "")
+	,	parameters(parameters)
+	,	first_above_time(TimePoint::max())
+	,	good_in_flight(1)
+	{  }
+
+	/** Default destructor
+	 *
+	 *  The inner handlers have to be destroyed before the admission control.
+	 */
+	virtual ~QueryServerAdmissionControl()
+	{  }
+
+	/** Forwards the request to the inner handlers or rejects it
+	 */
+	virtual void handleQuery(const QIDType &id, const RequestType& request) {
+		bool admitted = true;
+		{
+			std::unique_lock<std::mutex> lock(admission_mutex);
+			if(parameters.maxInFlight > 0 && arrival_times.size() >= parameters.maxInFlight) {
+				admitted = false;
+				statistics.rejectedInFlight++;
+			} else if(statistics.overloaded && arrival_times.size() >= std::max<std::size_t>(good_in_flight, 1)) {
+				admitted = false;
+				statistics.rejectedLatency++;
+			} else {
+				arrival_times[id] = std::chrono::steady_clock::now();
+				statistics.admitted++;
+			}
+		}
+
+		if(admitted == false && this->server->rejectQuery(id) != SMART_OK) {
+			// the client can not be informed about the rejection, thus the request is admitted nevertheless
+			std::unique_lock<std::mutex> lock(admission_mutex);
+			arrival_times[id] = std::chrono::steady_clock::now();
+			statistics.admitted++;
+			statistics.rejectionsUnsupported++;
+			admitted = true;
+		}
+
+		if(admitted) {
+			// deadlines and cancellations are tracked by the real server (see isQueryCancelled())
+			QueryServerInputType<RequestType,QIDType> input;
+			input.request = request;
+			input.query_id = id;
+			input.deadline = this->server->getQueryDeadline(id);
+			InputSubject< QueryServerInputType<RequestType,QIDType> >::notify_input(input);
+		}
+	}
+
+	/** Releases the admitted request and sends the answer via the real server
+	 */
+	virtual StatusCode answer(const QIDType& id, const AnswerType& answer) {
+		{
+			std::unique_lock<std::mutex> lock(admission_mutex);
+			this->release(id, true);
+		}
+		return this->server->answer(id, answer);
+	}
+
+	/** Forwards the chunk to the real server and releases the admitted request with the last chunk
+	 */
+	virtual StatusCode answerChunk(const QIDType& id, const AnswerType& chunk, const bool &lastChunk) {
+		if(lastChunk) {
+			std::unique_lock<std::mutex> lock(admission_mutex);
+			this->release(id, true);
+		}
+		return this->server->answerChunk(id, chunk, lastChunk);
+	}
+
+	/// forwards to the real server
+	virtual std::chrono::steady_clock::time_point getQueryDeadline(const QIDType& id) {
+		return this->server->getQueryDeadline(id);
+	}
+
+	/// forwards to the real server
+	virtual bool isQueryCancelled(const QIDType& id) {
+		return this->server->isQueryCancelled(id);
+	}
+
+	/** Forwards to the real server and releases the admitted request if it has been dropped
+	 */
+	virtual StatusCode discardQuery(const QIDType& id) {
+		StatusCode result = this->server->discardQuery(id);
+		if(result == SMART_OK) {
+			std::unique_lock<std::mutex> lock(admission_mutex);
+			this->release(id, false);
+		}
+		return result;
+	}
+
+	/** Forwards to the real server and releases the admitted request if it has been rejected
+	 */
+	virtual StatusCode rejectQuery(const QIDType& id) {
+		StatusCode result = this->server->rejectQuery(id);
+		if(result == SMART_OK) {
+			std::unique_lock<std::mutex> lock(admission_mutex);
+			this->release(id, false);
+		}
+		return result;
+	}
+
+	/** Sets new admission parameters (the in-flight requests are kept)
+	 */
+	void setParameters(const QueryAdmissionParameters &parameters) {
+		std::unique_lock<std::mutex> lock(admission_mutex);
+		this->parameters = parameters;
+		if(parameters.latencyTarget == std::chrono::steady_clock::duration::zero()) {
+			first_above_time = TimePoint::max();
+			statistics.overloaded = false;
+		}
+	}
+
+	/** Returns the admission statistics (see QueryAdmissionStatistics)
+	 */
+	QueryAdmissionStatistics getStatistics() {
+		std::unique_lock<std::mutex> lock(admission_mutex);
+		QueryAdmissionStatistics result = statistics;
+		result.inFlight = arrival_times.size();
+		result.overloadLimit = std::max<std::size_t>(good_in_flight, 1);
+		return result;
+	}
+};
+
+} /* namespace Smart */
+
+#endif /* SMARTSOFT_INTERFACES_SMARTQUERYSERVERADMISSIONCONTROL_T_H_ */
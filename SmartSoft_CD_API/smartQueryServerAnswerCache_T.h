@@ -0,0 +1,403 @@
+//===================================================================================
+//
+//  Copyright (C) 2017 Alex Lotz, Dennis Stampfer, Matthias Lutz, Christian Schlegel
+//
+//        lotz@hs-ulm.de
+//        stampfer@hs-ulm.de
+//        lutz@hs-ulm.de
+//        schlegel@hs-ulm.de
+//
+//        Servicerobotik Ulm
+//        Christian Schlegel
+//        Ulm University of Applied Sciences
+//        Prittwitzstr. 10
+//        89075 Ulm
+//        Germany
+//
+//  This file is part of the SmartSoft Component-Developer C++ API.
+//
+//  Redistribution and use in source and binary forms, with or without modification,
+//  are permitted provided that the following conditions are met:
+//
+//  1. Redistributions of source code must retain the above copyright notice,
+//     this list of conditions and the following disclaimer.
+//
+//  2. Redistributions in binary form must reproduce the above copyright notice,
+//     this list of conditions and the following disclaimer in the documentation
+//     and/or other materials provided with the distribution.
+//
+//  3. Neither the name of the copyright holder nor the names of its contributors
+//     may be used to endorse or promote products derived from this software
+//     without specific prior written permission.
+//
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+//  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+//  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+//  IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+//  INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+//  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+//  DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+//  LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE
+//  OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+//  OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+//===================================================================================
+
+#ifndef SMARTSOFT_INTERFACES_SMARTQUERYSERVERANSWERCACHE_T_H_
+#define SMARTSOFT_INTERFACES_SMARTQUERYSERVERANSWERCACHE_T_H_
+
+#include <map>
+#include <list>
+#include <cstddef>
+#include <functional>
+#include <unordered_map>
+
+// C++11 includes
+#include <chrono>
+#include <mutex>
+
+#include "smartIQueryServerPattern_T.h"
+#include "smartQueryAnswerChunkTraits_T.h"
+
+namespace Smart {
+
+/// statistics about the lookups of a QueryServerAnswerCache
+struct QueryAnswerCacheStatistics {
+	/// the number of requests answered from the cache
+	unsigned long hits;
+	/// the number of requests forwarded to the inner handlers
+	unsigned long misses;
+	/// the number of answers removed due to the maximum number of entries
+	unsigned long evictions;
+	/// the number of answers removed due to their time-to-live
+	unsigned long expirations;
+	/// the current number of cached answers
+	std::size_t entries;
+
+	QueryAnswerCacheStatistics()
+	:	hits(0)
+	,	misses(0)
+	,	evictions(0)
+	,	expirations(0)
+	,	entries(0)
+	{  }
+
+	/// returns the ratio of hits to all lookups (0 if there was no lookup yet)
+	double getHitRate() const {
+		return (hits + misses > 0)? static_cast<double>(hits) / (hits + misses) : 0.0;
+	}
+};
+
+/** Opt-in answer cache between an IQueryServerPattern and its IQueryServerHandler(s)
+ *
+ *  The cache observes the real query server and itself acts as the IQueryServerPattern for
+ *  the inner handlers, i.e. the inner handlers are constructed with a pointer to the cache
+ *  instead of the real server (this also works with a QueryServerTaskTrigger):
+ *
+ *  <pre>
+ *  QueryServerAnswerCache<Req,Ans,QID,ReqHash> cache(&server, std::chrono::seconds(10), 1000);
+ *  MyQueryHandler handler(&cache);
+ *  </pre>
+ *
+ *  A request whose answer is cached (and not yet expired) is answered directly by the
+ *  communication thread, i.e. without calling handleQuery() of the inner handlers. All other
+ *  requests are forwarded and their answers are stored in the cache when the inner handler
+ *  calls answer() (or answerChunk() with the last chunk of a streamed answer). Therefore, this
+ *  cache should only be used for services whose answers are a pure function of the request.
+ *
+ *  Requests are looked up by the value of RequestHash (which defaults to std::hash<RequestType>)
+ *  and a cached answer is only used if its request is equal to the new one (see RequestEqual),
+ *  so colliding hashes never result in a wrong answer. A cached request and answer is replaced
+ *  by the answer of a different request with the same hash.
+ *
+ *  Template parameters
+ *    - <b>RequestType</b>: request class (Communication Object)
+ *    - <b>AnswerType</b>: answer (reply) class (Communication Object)
+ *    - <b>QIDType</b>: the QueryId type of the middleware
+ *    - <b>RequestHash</b>: function object returning a std::size_t key for a request
+ *    - <b>RequestEqual</b>: function object comparing two requests for equality
+ */
+template<class RequestType, class AnswerType, class QIDType, class RequestHash=std::hash<RequestType>, class RequestEqual=std::equal_to<RequestType> >
+class QueryServerAnswerCache
+:	public IQueryServerHandler<RequestType,AnswerType,QIDType>
+,	public IQueryServerPattern<RequestType,AnswerType,QIDType>
+{
+private:
+	typedef std::chrono::steady_clock::time_point TimePoint;
+
+	struct CacheEntry {
+		std::size_t key;
+		// computed when the answer is stored (TimePoint::max() if it never expires)
+		TimePoint expiry;
+		RequestType request;
+		AnswerType answer;
+	};
+
+	// a forwarded request that has not been answered yet
+	struct PendingRequest {
+		std::size_t key;
+		// the value of generation when the request has been forwarded
+		unsigned long generation;
+		RequestType request;
+		// the chunks of a streamed answer received so far (see answerChunk())
+		AnswerType partial_answer;
+	};
+
+	std::mutex cache_mutex;
+	RequestHash request_hash;
+	RequestEqual request_equal;
+	std::chrono::steady_clock::duration time_to_live;
+	std::size_t max_entries;
+	// the cached answers in least-recently-used order (the front is the most recently used)
+	std::list<CacheEntry> lru_list;
+	std::unordered_map<std::size_t, typename std::list<CacheEntry>::iterator> entries;
+	std::map<QIDType, PendingRequest> pending_requests;
+	// incremented by invalidate() and clear(), answers of requests forwarded before are not stored
+	unsigned long generation;
+	QueryAnswerCacheStatistics statistics;
+
+	// removes least-recently-used entries until at most max entries remain (call with locked cache_mutex)
+	void evict(const std::size_t &max) {
+		while(lru_list.size() > max) {
+			entries.erase(lru_list.back().key);
+			lru_list.pop_back();
+			statistics.evictions++;
+		}
+	}
+
+	// stores the answer of a forwarded request (call with locked cache_mutex)
+	void store(PendingRequest &pending, const AnswerType &answer) {
+		auto it = entries.find(pending.key);
+		if(it == entries.end()) {
+			CacheEntry entry;
+			entry.key = pending.key;
+			lru_list.push_front(entry);
+			it = entries.insert(std::make_pair(pending.key, lru_list.begin())).first;
+		} else {
+			lru_list.splice(lru_list.begin(), lru_list, it->second);
+		}
+		using std::swap;
+		swap(it->second->request, pending.request);
+		it->second->answer = answer;
+		if(time_to_live == std::chrono::steady_clock::duration::zero()) {
+			it->second->expiry = TimePoint::max();
+		} else {
+			it->second->expiry = std::chrono::steady_clock::now() + time_to_live;
+		}
+		if(max_entries > 0) this->evict(max_entries);
+	}
+
+protected:
+	/// the real server is responsible for the disconnect of its clients
+	virtual void serverInitiatedDisconnect()
+	{  }
+
+public:
+	/** Default constructor
+	 *
+	 *  @param server        the real query server whose requests are cached
+	 *  @param timeToLive    the time an answer remains valid (zero keeps answers until they are evicted)
+	 *  @param maxEntries    the maximum number of cached answers (least-recently-used answers are evicted first, 0 means unlimited)
+	 *  @param requestHash   the function object used to look up requests
+	 *  @param requestEqual  the function object used to compare requests with the same hash
+	 */
+	QueryServerAnswerCache(IQueryServerPattern<RequestType,AnswerType,QIDType> *server,
+			const std::chrono::steady_clock::duration &timeToLive=std::chrono::steady_clock::duration::zero(),
+			const std::size_t &maxEntries=0, const RequestHash &requestHash=RequestHash(),
+			const RequestEqual &requestEqual=RequestEqual())
+	:	IQueryServerHandler<RequestType,AnswerType,QIDType>(server)
+	,	IQueryServerPattern<RequestType,AnswerType,QIDType>(0, "")
+	,	request_hash(requestHash)
+	,	request_equal(requestEqual)
+	,	time_to_live(timeToLive)
+	,	max_entries(maxEntries)
+	,	generation(0)
+	{  }
+
+	/** Default destructor
+	 *
+	 *  The inner handlers have to be destroyed before the cache.
+	 */
+	virtual ~QueryServerAnswerCache()
+	{  }
+
+	/** Answers the request from the cache or forwards it to the inner handlers
+	 */
+	virtual void handleQuery(const QIDType &id, const RequestType& request) {
+		const std::size_t key = request_hash(request);
+		AnswerType cached_answer;
+		bool hit = false;
+		{
+			std::unique_lock<std::mutex> lock(cache_mutex);
+			auto it = entries.find(key);
+			if(it != entries.end() && request_equal(it->second->request, request)) {
+				if(it->second->expiry <= std::chrono::steady_clock::now()) {
+					lru_list.erase(it->second);
+					entries.erase(it);
+					statistics.expirations++;
+				} else {
+					lru_list.splice(lru_list.begin(), lru_list, it->second);
+					cached_answer = it->second->answer;
+					hit = true;
+				}
+			}
+			if(hit) {
+				statistics.hits++;
+			} else {
+				statistics.misses++;
+				PendingRequest &pending = pending_requests[id];
+				pending.key = key;
+				pending.generation = generation;
+				pending.request = request;
+				pending.partial_answer = AnswerType();
+			}
+		}
+
+		if(hit) {
+			this->server->answer(id, cached_answer);
+		} else {
+			// deadlines and cancellations are tracked by the real server (see isQueryCancelled())
+			QueryServerInputType<RequestType,QIDType> input;
+			input.request = request;
+			input.query_id = id;
+			input.deadline = this->server->getQueryDeadline(id);
+			InputSubject< QueryServerInputType<RequestType,QIDType> >::notify_input(input);
+		}
+	}
+
+	/** Stores the answer of a forwarded request and sends it via the real server
+	 *
+	 *  The answer is sent but not stored if invalidate() or clear() has been called while
+	 *  the request was computed (the answer might be based on outdated data).
+	 *  Called by the inner handlers, see IQueryServerPattern::answer() for the return values.
+	 */
+	virtual StatusCode answer(const QIDType& id, const AnswerType& answer) {
+		{
+			std::unique_lock<std::mutex> lock(cache_mutex);
+			auto pending = pending_requests.find(id);
+			if(pending != pending_requests.end()) {
+				if(pending->second.generation == generation) this->store(pending->second, answer);
+				pending_requests.erase(pending);
+			}
+		}
+		return this->server->answer(id, answer);
+	}
+
+	/** Forwards the chunk to the real server and stores the assembled answer with the last chunk
+	 *
+	 *  The chunks of a forwarded request are assembled alongside (see QueryAnswerChunkTraits), the
+	 *  answer is not stored if it can not be assembled or if invalidate() or clear() has been called
+	 *  while the request was computed. Called by the inner handlers, see IQueryServerPattern::answerChunk().
+	 */
+	virtual StatusCode answerChunk(const QIDType& id, const AnswerType& chunk, const bool &lastChunk) {
+		{
+			std::unique_lock<std::mutex> lock(cache_mutex);
+			auto pending = pending_requests.find(id);
+			if(pending != pending_requests.end()) {
+				if(pending->second.generation != generation || !QueryAnswerChunkTraits<AnswerType>::append(pending->second.partial_answer, chunk)) {
+					pending_requests.erase(pending);
+				} else if(lastChunk) {
+					AnswerType assembled;
+					using std::swap;
+					swap(assembled, pending->second.partial_answer);
+					this->store(pending->second, assembled);
+					pending_requests.erase(pending);
+				}
+			}
+		}
+		return this->server->answerChunk(id, chunk, lastChunk);
+	}
+
+	/// forwards to the real server
+	virtual std::chrono::steady_clock::time_point getQueryDeadline(const QIDType& id) {
+		return this->server->getQueryDeadline(id);
+	}
+
+	/// forwards to the real server
+	virtual bool isQueryCancelled(const QIDType& id) {
+		return this->server->isQueryCancelled(id);
+	}
+
+	/** Drops a forwarded request without caching an answer via the real server
+	 */
+	virtual StatusCode discardQuery(const QIDType& id) {
+		StatusCode result = this->server->discardQuery(id);
+		if(result == SMART_OK) {
+			std::unique_lock<std::mutex> lock(cache_mutex);
+			pending_requests.erase(id);
+		}
+		return result;
+	}
+
+	/** Rejects a forwarded request without caching an answer via the real server
+	 */
+	virtual StatusCode rejectQuery(const QIDType& id) {
+		StatusCode result = this->server->rejectQuery(id);
+		if(result == SMART_OK) {
+			std::unique_lock<std::mutex> lock(cache_mutex);
+			pending_requests.erase(id);
+		}
+		return result;
+	}
+
+	/** Removes the cached answer of the given request (e.g. after the underlying data has changed)
+	 *
+	 *  The answers of all requests that are currently computed by the inner handlers are not
+	 *  stored anymore (they are still sent), since they might be based on the outdated data.
+	 */
+	void invalidate(const RequestType &request) {
+		std::unique_lock<std::mutex> lock(cache_mutex);
+		generation++;
+		auto it = entries.find(request_hash(request));
+		if(it != entries.end() && request_equal(it->second->request, request)) {
+			lru_list.erase(it->second);
+			entries.erase(it);
+		}
+	}
+
+	/** Removes all cached answers (answers currently computed are not stored, see invalidate())
+	 */
+	void clear() {
+		std::unique_lock<std::mutex> lock(cache_mutex);
+		generation++;
+		entries.clear();
+		lru_list.clear();
+	}
+
+	/** Sets the time-to-live of answers that are stored from now on
+	 *
+	 *  Answers that are already cached keep the expiry computed when they have been stored.
+	 */
+	void setTimeToLive(const std::chrono::steady_clock::duration &timeToLive) {
+		std::unique_lock<std::mutex> lock(cache_mutex);
+		time_to_live = timeToLive;
+	}
+
+	/** Sets the maximum number of cached answers (0 means unlimited) and evicts surplus answers
+	 */
+	void setMaxEntries(const std::size_t &maxEntries) {
+		std::unique_lock<std::mutex> lock(cache_mutex);
+		max_entries = maxEntries;
+		if(max_entries > 0) this->evict(max_entries);
+	}
+
+	/** Returns the lookup statistics (see QueryAnswerCacheStatistics)
+	 */
+	QueryAnswerCacheStatistics getStatistics() {
+		std::unique_lock<std::mutex> lock(cache_mutex);
+		QueryAnswerCacheStatistics result = statistics;
+		result.entries = lru_list.size();
+		return result;
+	}
+
+	/** Resets the lookup statistics (the cached answers are kept)
+	 */
+	void resetStatistics() {
+		std::unique_lock<std::mutex> lock(cache_mutex);
+		statistics = QueryAnswerCacheStatistics();
+	}
+};
+
+} /* namespace Smart */
+
+#endif /* SMARTSOFT_INTERFACES_SMARTQUERYSERVERANSWERCACHE_T_H_ */
@@ -0,0 +1,373 @@
+//===================================================================================
+//
+//  Copyright (C) 2017 Alex Lotz, Dennis Stampfer, Matthias Lutz, Christian Schlegel
+//
+//        lotz@hs-ulm.de
+//        stampfer@hs-ulm.de
+//        lutz@hs-ulm.de
+//        schlegel@hs-ulm.de
+//
+//        Servicerobotik Ulm
+//        Christian Schlegel
+//        Ulm University of Applied Sciences
+//        Prittwitzstr. 10
+//        89075 Ulm
+//        Germany
+//
+//  This file is part of the SmartSoft Component-Developer C++ API.
+//
+//  Redistribution and use in source and binary forms, with or without modification,
+//  are permitted provided that the following conditions are met:
+//
+//  1. Redistributions of source code must retain the above copyright notice,
+//     this list of conditions and the following disclaimer.
+//
+//  2. Redistributions in binary form must reproduce the above copyright notice,
+//     this list of conditions and the following disclaimer in the documentation
+//     and/or other materials provided with the distribution.
+//
+//  3. Neither the name of the copyright holder nor the names of its contributors
+//     may be used to endorse or promote products derived from this software
+//     without specific prior written permission.
+//
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+//  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+//  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+//  IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+//  INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+//  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+//  DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+//  LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE
+//  OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+//  OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+//===================================================================================
+
+#ifndef SMARTSOFT_INTERFACES_SMARTQUERYSERVERREQUESTCOALESCER_T_H_
+#define SMARTSOFT_INTERFACES_SMARTQUERYSERVERREQUESTCOALESCER_T_H_
+
+#include <map>
+#include <vector>
+#include <cstddef>
+#include <algorithm>
+#include <functional>
+#include <unordered_map>
+
+// C++11 includes
+#include <mutex>
+
+#include "smartIQueryServerPattern_T.h"
+#include "smartQueryAnswerChunkTraits_T.h"
+
+namespace Smart {
+
+/// statistics about the requests of a QueryServerRequestCoalescer
+struct QueryCoalescingStatistics {
+	/// the number of requests forwarded to the inner handlers
+	unsigned long forwarded;
+	/// the number of requests that have been attached to an identical in-flight request
+	unsigned long coalesced;
+	/// the current number of forwarded requests that have not been answered yet
+	std::size_t inFlight;
+
+	QueryCoalescingStatistics()
+	:	forwarded(0)
+	,	coalesced(0)
+	,	inFlight(0)
+	{  }
+};
+
+/** Single-flight decorator between an IQueryServerPattern and its IQueryServerHandler(s)
+ *
+ *  Like the QueryServerAnswerCache, the coalescer observes the real query server and itself
+ *  acts as the IQueryServerPattern for the inner handlers. A request is only forwarded to the
+ *  inner handlers if no identical request is in flight. Otherwise, its id is attached to the
+ *  in-flight request and, as soon as the inner handler calls answer() for the forwarded request,
+ *  the answer is sent to all waiting ids via IQueryServerPattern::answer() of the real server.
+ *  Thus, identical requests arriving at the same time are computed only once. In contrast to the
+ *  cache, nothing is kept after the answer has been sent (both decorators can be stacked).
+ *
+ *  In-flight requests are looked up by the value of RequestHash (which defaults to
+ *  std::hash<RequestType>) and a request is only attached if it is equal to the in-flight
+ *  request (see RequestEqual), requests with colliding hashes are forwarded separately.
+ *
+ *  Streamed answers (see IQueryServerPattern::answerChunk()) are forwarded chunk by chunk for
+ *  the forwarded request and assembled for the waiting requests (see QueryAnswerChunkTraits),
+ *  which receive the assembled answer together with the last chunk.
+ *
+ *  Template parameters
+ *    - <b>RequestType</b>: request class (Communication Object)
+ *    - <b>AnswerType</b>: answer (reply) class (Communication Object)
+ *    - <b>QIDType</b>: the QueryId type of the middleware
+ *    - <b>RequestHash</b>: function object returning a std::size_t key for a request
+ *    - <b>RequestEqual</b>: function object comparing two requests for equality
+ */
+template<class RequestType, class AnswerType, class QIDType, class RequestHash=std::hash<RequestType>, class RequestEqual=std::equal_to<RequestType> >
+class QueryServerRequestCoalescer
+:	public IQueryServerHandler<RequestType,AnswerType,QIDType>
+,	public IQueryServerPattern<RequestType,AnswerType,QIDType>
+{
+private:
+	typedef IQueryServerPattern<RequestType,AnswerType,QIDType> QueryServerType;
+
+	// a forwarded request that has not been answered yet
+	struct InFlightRequest {
+		std::size_t key;
+		RequestType request;
+		// the ids waiting for the forwarded request (excluding the forwarded id)
+		std::vector<QIDType> waiting_ids;
+		// set while the forwarded request is discarded or rejected (no further ids are attached)
+		bool detaching;
+		// the chunks of a streamed answer received so far (see answerChunk())
+		AnswerType partial_answer;
+		unsigned long chunks;
+		// set if the chunks can not be assembled
+		bool assembly_failed;
+
+		InFlightRequest()
+		:	key(0)
+		,	detaching(false)
+		,	chunks(0)
+		,	assembly_failed(false)
+		{  }
+	};
+
+	std::mutex coalescer_mutex;
+	RequestHash request_hash;
+	RequestEqual request_equal;
+	// the forwarded requests by their id
+	std::map<QIDType, InFlightRequest> in_flight;
+	// the ids of the forwarded requests with the given key (several ones if the hashes of different requests collide)
+	std::unordered_map< std::size_t, std::vector<QIDType> > forwarded_ids;
+	QueryCoalescingStatistics statistics;
+
+	// removes a forwarded request (call with locked coalescer_mutex)
+	void release(const typename std::map<QIDType, InFlightRequest>::iterator &it) {
+		auto forwarded = forwarded_ids.find(it->second.key);
+		if(forwarded != forwarded_ids.end()) {
+			std::vector<QIDType> &ids = forwarded->second;
+			ids.erase(std::remove(ids.begin(), ids.end(), it->first), ids.end());
+			if(ids.empty()) forwarded_ids.erase(forwarded);
+		}
+		in_flight.erase(it);
+	}
+
+	// returns the given id and all ids waiting for it
+	std::vector<QIDType> get_attached_ids(const QIDType &id) {
+		std::vector<QIDType> ids(1, id);
+		std::unique_lock<std::mutex> lock(coalescer_mutex);
+		auto it = in_flight.find(id);
+		if(it != in_flight.end()) {
+			ids.insert(ids.end(), it->second.waiting_ids.begin(), it->second.waiting_ids.end());
+		}
+		return ids;
+	}
+
+	// drops the forwarded request via the given method of the real server and, on success, all requests waiting for it
+	StatusCode drop_query(const QIDType& id, StatusCode (QueryServerType::*drop)(const QIDType&)) {
+		{
+			std::unique_lock<std::mutex> lock(coalescer_mutex);
+			auto it = in_flight.find(id);
+			if(it != in_flight.end()) it->second.detaching = true;
+		}
+		StatusCode result = (this->server->*drop)(id);
+		std::vector<QIDType> ids;
+		{
+			std::unique_lock<std::mutex> lock(coalescer_mutex);
+			auto it = in_flight.find(id);
+			// not in flight (anymore), e.g. the inner handler answered meanwhile
+			if(it == in_flight.end()) return result;
+			if(result != SMART_OK) {
+				it->second.detaching = false;
+				return result;
+			}
+			ids.swap(it->second.waiting_ids);
+			this->release(it);
+		}
+		for(auto it=ids.begin(); it!=ids.end(); it++) {
+			(this->server->*drop)(*it);
+		}
+		return result;
+	}
+
+protected:
+	/// the real server is responsible for the disconnect of its clients
+	virtual void serverInitiatedDisconnect()
+	{  }
+
+public:
+	/** Default constructor
+	 *
+	 *  @param server        the real query server whose requests are coalesced
+	 *  @param requestHash   the function object used to look up in-flight requests
+	 *  @param requestEqual  the function object used to compare requests with the same hash
+	 */
+	QueryServerRequestCoalescer(IQueryServerPattern<RequestType,AnswerType,QIDType> *server,
+			const RequestHash &requestHash=RequestHash(), const RequestEqual &requestEqual=RequestEqual())
+	:	IQueryServerHandler<RequestType,AnswerType,QIDType>(server)
+	,	IQueryServerPattern<RequestType,AnswerType,QIDType>(0, "")
+	,	request_hash(requestHash)
+	,	request_equal(requestEqual)
+	{  }
+
+	/** Default destructor
+	 *
+	 *  The inner handlers have to be destroyed before the coalescer.
+	 */
+	virtual ~QueryServerRequestCoalescer()
+	{  }
+
+	/** Attaches the request to an identical in-flight request or forwards it to the inner handlers
+	 */
+	virtual void handleQuery(const QIDType &id, const RequestType& request) {
+		const std::size_t key = request_hash(request);
+		{
+			std::unique_lock<std::mutex> lock(coalescer_mutex);
+			auto forwarded = forwarded_ids.find(key);
+			if(forwarded != forwarded_ids.end()) {
+				for(auto fid=forwarded->second.begin(); fid!=forwarded->second.end(); fid++) {
+					auto it = in_flight.find(*fid);
+					if(it != in_flight.end() && it->second.detaching == false && request_equal(it->second.request, request)) {
+						it->second.waiting_ids.push_back(id);
+						statistics.coalesced++;
+						return;
+					}
+				}
+			}
+			InFlightRequest &entry = in_flight[id];
+			entry.key = key;
+			entry.request = request;
+			forwarded_ids[key].push_back(id);
+			statistics.forwarded++;
+		}
+
+		// the forwarded request has no deadline of its own since the attached requests may wait longer
+		// (see getQueryDeadline() and isQueryCancelled())
+		QueryServerInputType<RequestType,QIDType> input;
+		input.request = request;
+		input.query_id = id;
+		InputSubject< QueryServerInputType<RequestType,QIDType> >::notify_input(input);
+	}
+
+	/** Sends the answer to the forwarded request and to all requests that are waiting for it
+	 *
+	 *  Called by the inner handlers, see IQueryServerPattern::answer() for the return values
+	 *  (which refer to the forwarded request).
+	 */
+	virtual StatusCode answer(const QIDType& id, const AnswerType& answer) {
+		std::vector<QIDType> ids;
+		{
+			std::unique_lock<std::mutex> lock(coalescer_mutex);
+			auto it = in_flight.find(id);
+			if(it != in_flight.end()) {
+				ids.swap(it->second.waiting_ids);
+				this->release(it);
+			}
+		}
+		StatusCode result = this->server->answer(id, answer);
+		for(auto it=ids.begin(); it!=ids.end(); it++) {
+			this->server->answer(*it, answer);
+		}
+		return result;
+	}
+
+	/** Forwards the chunk of the forwarded request and sends the assembled answer to all requests
+	 *  waiting for it together with the last chunk
+	 *
+	 *  If the chunks can not be assembled (see QueryAnswerChunkTraits), the waiting requests are
+	 *  discarded via the real server. Called by the inner handlers, see IQueryServerPattern::answerChunk()
+	 *  for the return values (which refer to the forwarded request).
+	 */
+	virtual StatusCode answerChunk(const QIDType& id, const AnswerType& chunk, const bool &lastChunk) {
+		std::vector<QIDType> ids;
+		AnswerType assembled;
+		bool assembly_failed = false;
+		{
+			std::unique_lock<std::mutex> lock(coalescer_mutex);
+			auto it = in_flight.find(id);
+			if(it != in_flight.end()) {
+				InFlightRequest &entry = it->second;
+				// requests might be attached until the last chunk, so the chunks are always assembled
+				if(entry.assembly_failed == false) {
+					if(entry.chunks == 0) {
+						entry.partial_answer = chunk;
+					} else if(!QueryAnswerChunkTraits<AnswerType>::append(entry.partial_answer, chunk)) {
+						entry.assembly_failed = true;
+						entry.partial_answer = AnswerType();
+					}
+				}
+				entry.chunks++;
+				if(lastChunk) {
+					ids.swap(entry.waiting_ids);
+					using std::swap;
+					swap(assembled, entry.partial_answer);
+					assembly_failed = entry.assembly_failed;
+					this->release(it);
+				}
+			}
+		}
+		StatusCode result = this->server->answerChunk(id, chunk, lastChunk);
+		for(auto it=ids.begin(); it!=ids.end(); it++) {
+			if(assembly_failed) {
+				this->server->discardQuery(*it);
+			} else {
+				this->server->answer(*it, assembled);
+			}
+		}
+		return result;
+	}
+
+	/** Returns the latest deadline of the forwarded request and all requests waiting for it
+	 */
+	virtual std::chrono::steady_clock::time_point getQueryDeadline(const QIDType& id) {
+		const std::vector<QIDType> ids = this->get_attached_ids(id);
+		std::chrono::steady_clock::time_point deadline = std::chrono::steady_clock::time_point::min();
+		for(auto it=ids.begin(); it!=ids.end(); it++) {
+			deadline = std::max(deadline, this->server->getQueryDeadline(*it));
+		}
+		return deadline;
+	}
+
+	/** Returns true only if the forwarded request and all requests waiting for it expired or have been cancelled
+	 */
+	virtual bool isQueryCancelled(const QIDType& id) {
+		const std::vector<QIDType> ids = this->get_attached_ids(id);
+		for(auto it=ids.begin(); it!=ids.end(); it++) {
+			if(this->server->isQueryCancelled(*it) == false) return false;
+		}
+		return true;
+	}
+
+	/** Drops the forwarded request and all requests waiting for it via the real server
+	 *
+	 *  The forwarded request stays in flight until the real server dropped it (identical requests
+	 *  arriving meanwhile are forwarded anew). If the real server does not drop the forwarded
+	 *  request, the waiting requests remain attached.
+	 */
+	virtual StatusCode discardQuery(const QIDType& id) {
+		return this->drop_query(id, &QueryServerType::discardQuery);
+	}
+
+	/** Rejects the forwarded request and all requests waiting for it via the real server
+	 *
+	 *  The forwarded request stays in flight until the real server rejected it (identical requests
+	 *  arriving meanwhile are forwarded anew). If the real server does not reject the forwarded
+	 *  request, the waiting requests remain attached.
+	 */
+	virtual StatusCode rejectQuery(const QIDType& id) {
+		return this->drop_query(id, &QueryServerType::rejectQuery);
+	}
+
+	/** Returns the request statistics (see QueryCoalescingStatistics)
+	 */
+	QueryCoalescingStatistics getStatistics() {
+		std::unique_lock<std::mutex> lock(coalescer_mutex);
+		QueryCoalescingStatistics result = statistics;
+		result.inFlight = in_flight.size();
+		return result;
+	}
+};
+
+} /* namespace Smart */
+
+#endif /* SMARTSOFT_INTERFACES_SMARTQUERYSERVERREQUESTCOALESCER_T_H_ */
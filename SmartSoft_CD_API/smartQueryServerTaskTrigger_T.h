@@ -47,53 +47,265 @@
 #ifndef SMARTQUERYSERVERTASKTRIGGER_T_H_
 #define SMARTQUERYSERVERTASKTRIGGER_T_H_
 
-#include <list>
+#include <string>
+#include <vector>
+#include <utility>
+#include <algorithm>
 #include <mutex>
 
 #include "smartIQueryServerPattern_T.h"
 #include "smartTaskTriggerObserver.h"
+#include "smartRingBuffer_T.h"
 
 namespace Smart {
 
+/** The behavior of a bounded QueryServerTaskTrigger whose request queue is full
+ */
+enum QueryRequestOverflowPolicy {
+	/// the incoming request is rejected
+	QUERY_OVERFLOW_REJECT_NEWEST = 0,
+	/// the oldest queued request is shed in favor of the incoming request
+	QUERY_OVERFLOW_SHED_OLDEST
+};
+
+/** global function used to convert a QueryRequestOverflowPolicy into ASCII representation.
+ *
+ *  @param policy QueryRequestOverflowPolicy
+ */
+inline std::string QueryRequestOverflowPolicyString(const QueryRequestOverflowPolicy &policy)
+{
+	if(QUERY_OVERFLOW_REJECT_NEWEST == policy) return "QUERY_OVERFLOW_REJECT_NEWEST";
+	else if(QUERY_OVERFLOW_SHED_OLDEST == policy) return "QUERY_OVERFLOW_SHED_OLDEST";
+	else return "NA";
+}
+
+/** Queues incoming query requests and triggers the attached tasks
+ *
+ *  The requests are stored in a preallocated RingBuffer. The slots of consumed requests are
+ *  recycled: an incoming request is copy-assigned into a recycled slot (reusing e.g. the
+ *  capacity of contained vectors) and consumeRequest() swaps the request out into the caller's
+ *  object, so that the caller's old buffers return into the ring. Thus, large requests (e.g. map
+ *  regions or trajectories) do not cause heap allocations in steady state.
+ *
+ *  The queue is either unbounded (the ring grows on demand) or bounded to a maximum number of
+ *  pending requests. When a bounded queue is full, either the incoming or the oldest request
+ *  is dropped (see QueryRequestOverflowPolicy) and on_request_rejected() is called for it. If the
+ *  client can not be informed about the rejection (see IQueryServerPattern::rejectQuery()), the
+ *  request is queued at the end nevertheless, i.e. the queue exceeds its bound.
+ *
+ *  Requests that expire while they are queued (or are cancelled by the client) are skipped
+ *  by consumeRequest() and consumeRequests() if on_request_expired() dropped them.
+ */
 template<class RequestType, class AnswerType, class QIDType>
 class QueryServerTaskTrigger
 :	public IQueryServerHandler<RequestType,AnswerType,QIDType>
 ,	public TaskTriggerSubject
 {
 private:
+	struct RequestEntry {
+		QIDType id;
+		RequestType request;
+	};
+
 	std::mutex requestMutex;
-	std::list<std::pair<QIDType,RequestType>> requestList;
+	RingBuffer<RequestEntry> requestQueue;
+	std::size_t maxRequests;
+	QueryRequestOverflowPolicy overflowPolicy;
+	unsigned long rejectedRequests;
+	unsigned long expiredRequests;
+
+	// skips a consumed request whose answer is not needed anymore (call without locked requestMutex)
+	bool skip_expired_request(const QIDType &id) {
+		if(this->server->isQueryCancelled(id) == false) return false;
+		if(this->on_request_expired(id) == false) return false;
+		std::unique_lock<std::mutex> lock (requestMutex);
+		expiredRequests++;
+		return true;
+	}
+
 protected:
 	virtual void handleQuery(const QIDType &id, const RequestType& request) {
-		std::unique_lock<std::mutex> lock (requestMutex);
-		// store the request entry in a list
-		requestList.push_back(std::pair<QIDType,RequestType>(id,request));
-		// trigger all observer tasks
-		this->trigger_all_tasks();
+		bool rejected = false;
+		RequestEntry rejected_entry;
+		{
+			std::unique_lock<std::mutex> lock (requestMutex);
+			if(requestQueue.isFull()) {
+				if(maxRequests == 0) {
+					// the unbounded queue grows on demand
+					requestQueue.resize(std::max<std::size_t>(16, 2*requestQueue.capacity()));
+				} else if(overflowPolicy == QUERY_OVERFLOW_REJECT_NEWEST) {
+					rejected = true;
+					rejected_entry.id = id;
+				} else {
+					rejected = true;
+					rejected_entry.id = requestQueue.front().id;
+					using std::swap;
+					swap(rejected_entry.request, requestQueue.front().request);
+					requestQueue.popFront();
+				}
+			}
+			if(rejected == false || overflowPolicy == QUERY_OVERFLOW_SHED_OLDEST) {
+				// store the request entry in a recycled slot of the ring
+				RequestEntry *entry = requestQueue.pushSlot();
+				entry->id = id;
+				entry->request = request;
+				// trigger all observer tasks
+				this->trigger_all_tasks();
+			}
+		}
+		if(rejected == true) {
+			const bool dropped = this->on_request_rejected(rejected_entry.id);
+			std::unique_lock<std::mutex> lock (requestMutex);
+			if(dropped == true) {
+				rejectedRequests++;
+			} else {
+				// the client can not be informed, thus the request is queued nevertheless
+				if(requestQueue.isFull()) requestQueue.resize(2*requestQueue.capacity());
+				RequestEntry *entry = requestQueue.pushSlot();
+				entry->id = rejected_entry.id;
+				if(overflowPolicy == QUERY_OVERFLOW_REJECT_NEWEST) {
+					entry->request = request;
+				} else {
+					using std::swap;
+					swap(entry->request, rejected_entry.request);
+				}
+				this->trigger_all_tasks();
+			}
+		}
+	}
+
+	/** user hook that is called for each request that is dropped from a full queue
+	 *
+	 *  This hook is called from within handleQuery() (i.e. the communication thread) outside
+	 *  of the internal lock. The default implementation calls IQueryServerPattern::rejectQuery(),
+	 *  so that the requesting client does not wait forever.
+	 *
+	 *  @param id the id of the dropped request
+	 *
+	 *  @return true if the request has been dropped or false if it has to be queued nevertheless
+	 *          (e.g. because the middleware does not support rejectQuery())
+	 */
+	virtual bool on_request_rejected(const QIDType &id) {
+		return this->server->rejectQuery(id) == SMART_OK;
 	}
+
 public:
-	QueryServerTaskTrigger(IQueryServerPattern<RequestType,AnswerType,QIDType>* server)
+	/** Default constructor
+	 *
+	 *  @param server the query server whose requests are queued
+	 *  @param maxRequests the maximum number of pending requests (0 for an unbounded queue)
+	 *  @param overflowPolicy the behavior if the bounded queue is full
+	 */
+	QueryServerTaskTrigger(
+			IQueryServerPattern<RequestType,AnswerType,QIDType>* server,
+			const std::size_t &maxRequests=0,
+			const QueryRequestOverflowPolicy &overflowPolicy=QUERY_OVERFLOW_REJECT_NEWEST
+		)
 	:	IQueryServerHandler<RequestType,AnswerType,QIDType>(server)
+	,	requestQueue((maxRequests > 0)? maxRequests : 16)
+	,	maxRequests(maxRequests)
+	,	overflowPolicy(overflowPolicy)
+	,	rejectedRequests(0)
+	,	expiredRequests(0)
 	{ }
 	virtual ~QueryServerTaskTrigger()
 	{ }
 
 	inline Smart::StatusCode consumeRequest(QIDType& id, RequestType &request) {
-		std::unique_lock<std::mutex> lock (requestMutex);
-		if(!requestList.empty()) {
-			// copy request data
-			id = requestList.front().first;
-			request = requestList.front().second;
+		do {
+			std::unique_lock<std::mutex> lock (requestMutex);
+			if(requestQueue.isEmpty()) {
+				return SMART_NODATA;
+			}
+			RequestEntry &entry = requestQueue.front();
+			id = entry.id;
+			// swap the request out (the old content of the caller's object is recycled by the ring)
+			using std::swap;
+			swap(request, entry.request);
 			// consume the current request item
-			requestList.pop_front();
-			return SMART_OK;
+			requestQueue.popFront();
+		} while(this->skip_expired_request(id));
+		return SMART_OK;
+	}
+
+	/** Consumes several pending requests under a single lock
+	 *
+	 *  The vector is resized to the number of consumed requests. The requests are swapped
+	 *  into the existing elements, so reusing the same vector across calls recycles the
+	 *  buffers of both the vector's elements and the ring's slots.
+	 *
+	 *  @param requests is set to the consumed pairs of request ids and requests (in arrival order)
+	 *  @param maxCount the maximum number of requests to consume (0 for all pending requests)
+	 *
+	 *  @return SMART_OK if at least one request has been consumed or SMART_NODATA otherwise
+	 */
+	inline Smart::StatusCode consumeRequests(std::vector< std::pair<QIDType,RequestType> > &requests, const std::size_t &maxCount=0) {
+		using std::swap;
+		while(true) {
+			std::size_t count = 0;
+			{
+				std::unique_lock<std::mutex> lock (requestMutex);
+				count = requestQueue.size();
+				if(maxCount > 0 && maxCount < count) count = maxCount;
+				requests.resize(count);
+				for(std::size_t i=0; i<count; ++i) {
+					RequestEntry &entry = requestQueue.front();
+					requests[i].first = entry.id;
+					swap(requests[i].second, entry.request);
+					requestQueue.popFront();
+				}
+			}
+			if(count == 0) return SMART_NODATA;
+
+			// compact the batch by skipping the expired requests
+			std::size_t valid = 0;
+			for(std::size_t i=0; i<count; ++i) {
+				if(this->skip_expired_request(requests[i].first) == false) {
+					if(valid != i) swap(requests[valid], requests[i]);
+					++valid;
+				}
+			}
+			requests.resize(valid);
+			if(valid > 0) return SMART_OK;
 		}
-		return SMART_NODATA;
 	}
 
 	inline Smart::StatusCode answer(const QIDType& id, const AnswerType& answer) {
 		return this->server->answer(id, answer);
 	}
+
+	/// forwards the chunk to IQueryServerPattern::answerChunk()
+	inline Smart::StatusCode answerChunk(const QIDType& id, const AnswerType& chunk, const bool &lastChunk) {
+		return this->server->answerChunk(id, chunk, lastChunk);
+	}
+
+	/// forwards the answers to IQueryServerPattern::answerBatch()
+	inline Smart::StatusCode answerBatch(const std::vector< std::pair<QIDType,AnswerType> > &answers) {
+		return this->server->answerBatch(answers);
+	}
+
+	/// forwards to IQueryServerPattern::isQueryCancelled() (e.g. to abort long computations)
+	inline bool isQueryCancelled(const QIDType& id) {
+		return this->server->isQueryCancelled(id);
+	}
+
+	/// returns the number of pending (not yet consumed) requests
+	inline std::size_t getPendingRequests() {
+		std::unique_lock<std::mutex> lock (requestMutex);
+		return requestQueue.size();
+	}
+
+	/// returns the number of requests rejected because the queue was full
+	inline unsigned long getRejectedRequests() {
+		std::unique_lock<std::mutex> lock (requestMutex);
+		return rejectedRequests;
+	}
+
+	/// returns the number of consumed requests that have been skipped because they expired or were cancelled
+	inline unsigned long getExpiredRequests() {
+		std::unique_lock<std::mutex> lock (requestMutex);
+		return expiredRequests;
+	}
 };
 
 } /* namespace Smart */
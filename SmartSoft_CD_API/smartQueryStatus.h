@@ -67,7 +67,9 @@ namespace Smart {
 		/// this indicates a query-request that became invalid due to a closed connection
 		QUERY_DISCONNECTED = 2,
 		/// this indicates a wrong id of a query-request (i.e. a request that does no longer exists)
-		QUERY_WRONGID      = 3
+		QUERY_WRONGID      = 3,
+		/// this indicates a query-request that has been rejected by the server (e.g. due to overload)
+		QUERY_REJECTED     = 4
 	};
 
 	/** global function used to convert a QueryStatus into ASCII representation.
@@ -80,6 +82,7 @@ namespace Smart {
 		else if(QUERY_VALIDANSWER == qs) return "QUERY_VALIDANSWER";
 		else if(QUERY_DISCONNECTED == qs) return "QUERY_DISCONNECTED";
 		else if(QUERY_WRONGID == qs) return "QUERY_WRONGID";
+		else if(QUERY_REJECTED == qs) return "QUERY_REJECTED";
 		else return "NA";
 	}
 
@@ -0,0 +1,161 @@
+//===================================================================================
+//
+//  Copyright (C) 2017 Alex Lotz, Dennis Stampfer, Matthias Lutz, Christian Schlegel
+//
+//        lotz@hs-ulm.de
+//        stampfer@hs-ulm.de
+//        lutz@hs-ulm.de
+//        schlegel@hs-ulm.de
+//
+//        Servicerobotik Ulm
+//        Christian Schlegel
+//        Ulm University of Applied Sciences
+//        Prittwitzstr. 10
+//        89075 Ulm
+//        Germany
+//
+//  This file is part of the SmartSoft Component-Developer C++ API.
+//
+//  Redistribution and use in source and binary forms, with or without modification,
+//  are permitted provided that the following conditions are met:
+//
+//  1. Redistributions of source code must retain the above copyright notice,
+//     this list of conditions and the following disclaimer.
+//
+//  2. Redistributions in binary form must reproduce the above copyright notice,
+//     this list of conditions and the following disclaimer in the documentation
+//     and/or other materials provided with the distribution.
+//
+//  3. Neither the name of the copyright holder nor the names of its contributors
+//     may be used to endorse or promote products derived from this software
+//     without specific prior written permission.
+//
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+//  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+//  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+//  IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+//  INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+//  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+//  DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+//  LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE
+//  OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+//  OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+//===================================================================================
+
+#ifndef SMARTSOFT_INTERFACES_SMARTRINGBUFFER_T_H_
+#define SMARTSOFT_INTERFACES_SMARTRINGBUFFER_T_H_
+
+#include <vector>
+#include <cstddef>
+#include <utility>
+
+namespace Smart {
+
+/** A FIFO queue on top of a preallocated ring of slots (not thread safe)
+ *
+ *  In contrast to a std::list or std::deque, the elements are never destroyed when they are
+ *  consumed: a consumed slot keeps its object (including the heap memory it owns) and is
+ *  reused by a later pushSlot(). Assigning new content to a recycled slot thus typically
+ *  reuses the capacity of e.g. contained vectors and strings, so a queue in steady state
+ *  runs without any heap allocations. Consumers can move or swap the content out of front().
+ *
+ *  The element type needs to be default constructible and move assignable.
+ */
+template <class T>
+class RingBuffer {
+private:
+	std::vector<T> slots;
+	std::size_t head;
+	std::size_t count;
+
+public:
+	/** Default constructor
+	 *
+	 *  @param capacity the number of preallocated slots
+	 */
+	RingBuffer(const std::size_t &capacity=16)
+	:	slots(capacity)
+	,	head(0)
+	,	count(0)
+	{  }
+
+	/// returns the number of queued elements
+	inline std::size_t size() const {
+		return count;
+	}
+
+	/// returns the number of slots
+	inline std::size_t capacity() const {
+		return slots.size();
+	}
+
+	inline bool isEmpty() const {
+		return count == 0;
+	}
+
+	inline bool isFull() const {
+		return count == slots.size();
+	}
+
+	/** Appends a new element
+	 *
+	 *  The returned slot still contains a previously consumed (or a default constructed)
+	 *  object, which has to be overwritten by the caller.
+	 *
+	 *  @return the slot of the new element or 0 if the ring is full
+	 */
+	inline T* pushSlot() {
+		if(this->isFull()) return 0;
+		std::size_t index = head + count;
+		if(index >= slots.size()) index -= slots.size();
+		count++;
+		return &slots[index];
+	}
+
+	/// returns the oldest element (the ring must not be empty)
+	inline T& front() {
+		return slots[head];
+	}
+
+	/// returns the i-th oldest element (i must be less than size())
+	inline T& at(const std::size_t &i) {
+		std::size_t index = head + i;
+		if(index >= slots.size()) index -= slots.size();
+		return slots[index];
+	}
+
+	/// consumes the oldest element (its slot is kept for reuse)
+	inline void popFront() {
+		if(count == 0) return;
+		if(++head == slots.size()) head = 0;
+		count--;
+	}
+
+	/// consumes all elements
+	inline void clear() {
+		head = 0;
+		count = 0;
+	}
+
+	/** Changes the number of slots (the queued elements are moved in order)
+	 *
+	 *  @param capacity the new capacity (must not be less than size())
+	 *
+	 *  @return true on success or false if the capacity is too small
+	 */
+	bool resize(const std::size_t &capacity) {
+		if(capacity < count) return false;
+		std::vector<T> resized(capacity);
+		for(std::size_t i=0; i<count; ++i) {
+			resized[i] = std::move(this->at(i));
+		}
+		slots.swap(resized);
+		head = 0;
+		return true;
+	}
+};
+
+} /* namespace Smart */
+
+#endif /* SMARTSOFT_INTERFACES_SMARTRINGBUFFER_T_H_ */
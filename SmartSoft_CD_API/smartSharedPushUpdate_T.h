@@ -0,0 +1,116 @@
+//===================================================================================
+//
+//  Copyright (C) 2017 Alex Lotz, Dennis Stampfer, Matthias Lutz, Christian Schlegel
+//
+//        lotz@hs-ulm.de
+//        stampfer@hs-ulm.de
+//        lutz@hs-ulm.de
+//        schlegel@hs-ulm.de
+//
+//        Servicerobotik Ulm
+//        Christian Schlegel
+//        Ulm University of Applied Sciences
+//        Prittwitzstr. 10
+//        89075 Ulm
+//        Germany
+//
+//  This file is part of the SmartSoft Component-Developer C++ API.
+//
+//  Redistribution and use in source and binary forms, with or without modification,
+//  are permitted provided that the following conditions are met:
+//
+//  1. Redistributions of source code must retain the above copyright notice,
+//     this list of conditions and the following disclaimer.
+//
+//  2. Redistributions in binary form must reproduce the above copyright notice,
+//     this list of conditions and the following disclaimer in the documentation
+//     and/or other materials provided with the distribution.
+//
+//  3. Neither the name of the copyright holder nor the names of its contributors
+//     may be used to endorse or promote products derived from this software
+//     without specific prior written permission.
+//
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+//  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+//  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+//  IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+//  INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+//  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+//  DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+//  LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE
+//  OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+//  OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+//===================================================================================
+
+#ifndef SMARTSOFT_INTERFACES_SMARTSHAREDPUSHUPDATE_T_H_
+#define SMARTSOFT_INTERFACES_SMARTSHAREDPUSHUPDATE_T_H_
+
+// C++11 includes
+#include <memory>
+#include <mutex>
+
+namespace Smart {
+
+/** A pushed update that is shared by all subscribers and serialized at most once
+ *
+ *  Push server implementations create one SharedPushUpdate per IPushServerPattern::put()
+ *  and hand it (e.g. as std::shared_ptr) to the send paths of all subscribers that are due.
+ *  The first send path that needs the serialized representation calls getBuffer(), which
+ *  serializes the data, while all other (possibly concurrent) callers wait for and share
+ *  the same buffer. Subscribers that are not due never trigger a serialization.
+ *
+ *  Template parameters
+ *    - <b>DataType</b>: Pushed value class (Communication Object)
+ *    - <b>BufferType</b>: the middleware-specific serialized representation (e.g. a byte vector)
+ */
+template <class DataType, class BufferType>
+class SharedPushUpdate {
+private:
+	std::shared_ptr<const DataType> data;
+	std::once_flag serialized_flag;
+	std::shared_ptr<const BufferType> buffer;
+
+	SharedPushUpdate(const SharedPushUpdate&);
+	SharedPushUpdate& operator=(const SharedPushUpdate&);
+
+public:
+	/** Default constructor
+	 *
+	 *  @param data the pushed data (shared with the caller of put(), no copy is made)
+	 */
+	explicit SharedPushUpdate(const std::shared_ptr<const DataType> &data)
+	:	data(data)
+	{  }
+
+	/// returns the pushed data
+	inline const std::shared_ptr<const DataType>& getData() const {
+		return data;
+	}
+
+	/// returns the pushed data
+	inline const DataType& operator*() const {
+		return *data;
+	}
+
+	/** Returns the serialized data, which is created by the first call only
+	 *
+	 *  @param serialize a function object with the signature void(const DataType&, BufferType&),
+	 *                   which is called at most once (with a default constructed buffer)
+	 *
+	 *  @return the shared serialized data
+	 */
+	template <class Serializer>
+	std::shared_ptr<const BufferType> getBuffer(Serializer serialize) {
+		std::call_once(serialized_flag, [this, &serialize]() {
+			std::shared_ptr<BufferType> serialized = std::make_shared<BufferType>();
+			serialize(*data, *serialized);
+			buffer = serialized;
+		});
+		return buffer;
+	}
+};
+
+} /* namespace Smart */
+
+#endif /* SMARTSOFT_INTERFACES_SMARTSHAREDPUSHUPDATE_T_H_ */
@@ -0,0 +1,264 @@
+//===================================================================================
+//
+//  Copyright (C) 2017 Alex Lotz, Dennis Stampfer, Matthias Lutz, Christian Schlegel
+//
+//        lotz@hs-ulm.de
+//        stampfer@hs-ulm.de
+//        lutz@hs-ulm.de
+//        schlegel@hs-ulm.de
+//
+//        Servicerobotik Ulm
+//        Christian Schlegel
+//        Ulm University of Applied Sciences
+//        Prittwitzstr. 10
+//        89075 Ulm
+//        Germany
+//
+//  This file is part of the SmartSoft Component-Developer C++ API.
+//
+//  Redistribution and use in source and binary forms, with or without modification,
+//  are permitted provided that the following conditions are met:
+//
+//  1. Redistributions of source code must retain the above copyright notice,
+//     this list of conditions and the following disclaimer.
+//
+//  2. Redistributions in binary form must reproduce the above copyright notice,
+//     this list of conditions and the following disclaimer in the documentation
+//     and/or other materials provided with the distribution.
+//
+//  3. Neither the name of the copyright holder nor the names of its contributors
+//     may be used to endorse or promote products derived from this software
+//     without specific prior written permission.
+//
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+//  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+//  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+//  IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+//  INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+//  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+//  DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+//  LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE
+//  OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+//  OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+//===================================================================================
+
+#ifndef SMARTSOFT_INTERFACES_SMARTSLOTMAP_T_H_
+#define SMARTSOFT_INTERFACES_SMARTSLOTMAP_T_H_
+
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+#include <algorithm>
+#include <functional>
+
+namespace Smart {
+
+/** The id of an element in a SlotMap
+ *
+ *  The id combines the index of the slot with the generation of the slot at insertion time.
+ *  Since the generation of a slot changes whenever its element is erased, an id of an erased
+ *  element is detected as stale even after the slot has been reused. A default constructed id
+ *  is invalid. The id is copyable, comparable and hashable and can thus be used as QIDType.
+ */
+struct SlotMapId {
+	/// the index of the slot
+	uint32_t index;
+	/// the generation of the slot (odd for ids of inserted elements)
+	uint32_t generation;
+
+	SlotMapId()
+	:	index(0)
+	,	generation(0)
+	{  }
+
+	SlotMapId(const uint32_t &index, const uint32_t &generation)
+	:	index(index)
+	,	generation(generation)
+	{  }
+
+	/// returns false for default constructed ids
+	inline bool isValid() const {
+		return (generation & 1u) != 0;
+	}
+
+	inline bool operator==(const SlotMapId &other) const {
+		return index == other.index && generation == other.generation;
+	}
+
+	inline bool operator!=(const SlotMapId &other) const {
+		return !(*this == other);
+	}
+
+	inline bool operator<(const SlotMapId &other) const {
+		return (index < other.index) || (index == other.index && generation < other.generation);
+	}
+};
+
+/** A container with O(1) insert, find and erase by generational ids (not thread safe)
+ *
+ *  The elements are stored in a vector of slots and the free slots are linked in a free-list,
+ *  thus none of the operations allocates memory as long as the capacity is not exceeded (the
+ *  slots grow on demand, see also reserve()). Like in the RingBuffer, the elements of erased
+ *  slots are not destroyed but reused by a later insertSlot(), so the heap memory owned by the
+ *  elements is recycled as well.
+ *
+ *  Each slot counts generations (even while free, odd while occupied), so that find() and erase()
+ *  reject ids of erased elements (SlotMapId) in O(1). Note that the generation of a slot wraps
+ *  around after 2^31 reuses.
+ *
+ *  The element type needs to be default constructible and move assignable. Pointers to elements
+ *  are invalidated if the slots grow.
+ */
+template <class T>
+class SlotMap {
+private:
+	static const uint32_t NO_SLOT = 0xffffffffu;
+
+	struct Slot {
+		T value;
+		uint32_t generation;
+		uint32_t next_free;
+
+		Slot()
+		:	generation(0)
+		,	next_free(NO_SLOT)
+		{  }
+	};
+
+	std::vector<Slot> slots;
+	uint32_t free_head;
+	std::size_t count;
+
+	// appends new free slots up to the given capacity
+	void grow(const std::size_t &capacity) {
+		if(capacity <= slots.size() || capacity >= NO_SLOT) return;
+		const uint32_t first = static_cast<uint32_t>(slots.size());
+		slots.resize(capacity);
+		// prepend the new slots to the free-list (in ascending order)
+		for(uint32_t i=static_cast<uint32_t>(capacity)-1; i>first; --i) {
+			slots[i-1].next_free = i;
+		}
+		slots[capacity-1].next_free = free_head;
+		free_head = first;
+	}
+
+public:
+	/** Default constructor
+	 *
+	 *  @param capacity the number of preallocated slots
+	 */
+	SlotMap(const std::size_t &capacity=16)
+	:	free_head(NO_SLOT)
+	,	count(0)
+	{
+		this->grow(capacity);
+	}
+
+	/// returns the number of elements
+	inline std::size_t size() const {
+		return count;
+	}
+
+	/// returns the number of slots
+	inline std::size_t capacity() const {
+		return slots.size();
+	}
+
+	inline bool isEmpty() const {
+		return count == 0;
+	}
+
+	/// preallocates slots for the given number of elements
+	inline void reserve(const std::size_t &capacity) {
+		this->grow(capacity);
+	}
+
+	/** Inserts a new element
+	 *
+	 *  The returned slot still contains a previously erased (or a default constructed)
+	 *  object, which has to be overwritten by the caller.
+	 *
+	 *  @param id is set to the id of the new element
+	 *
+	 *  @return the slot of the new element or 0 if the maximum number of slots is reached
+	 */
+	inline T* insertSlot(SlotMapId &id) {
+		if(free_head == NO_SLOT) {
+			this->grow(std::max<std::size_t>(16, 2*slots.size()));
+			if(free_head == NO_SLOT) return 0;
+		}
+		Slot &slot = slots[free_head];
+		id.index = free_head;
+		id.generation = ++slot.generation;
+		free_head = slot.next_free;
+		slot.next_free = NO_SLOT;
+		count++;
+		return &slot.value;
+	}
+
+	/** Inserts a copy of the given element
+	 *
+	 *  @return the id of the new element (an invalid id if the maximum number of slots is reached)
+	 */
+	inline SlotMapId insert(const T &value) {
+		SlotMapId id;
+		T *slot = this->insertSlot(id);
+		if(slot == 0) return SlotMapId();
+		*slot = value;
+		return id;
+	}
+
+	/// returns the element with the given id or 0 if the id is stale or invalid
+	inline T* find(const SlotMapId &id) {
+		if(id.index >= slots.size() || slots[id.index].generation != id.generation || !id.isValid()) return 0;
+		return &slots[id.index].value;
+	}
+
+	/// returns true if the element with the given id has not been erased yet
+	inline bool contains(const SlotMapId &id) const {
+		return id.index < slots.size() && slots[id.index].generation == id.generation && id.isValid();
+	}
+
+	/** Erases the element with the given id (its slot and object are kept for reuse)
+	 *
+	 *  @return true on success or false if the id is stale or invalid
+	 */
+	inline bool erase(const SlotMapId &id) {
+		if(!this->contains(id)) return false;
+		Slot &slot = slots[id.index];
+		slot.generation++;
+		slot.next_free = free_head;
+		free_head = id.index;
+		count--;
+		return true;
+	}
+
+	/// erases all elements (all ids become stale)
+	void clear() {
+		for(uint32_t i=0; i<slots.size(); ++i) {
+			if(slots[i].generation & 1u) {
+				slots[i].generation++;
+				slots[i].next_free = free_head;
+				free_head = i;
+			}
+		}
+		count = 0;
+	}
+};
+
+} /* namespace Smart */
+
+namespace std {
+
+/// allows SlotMapId as key of unordered containers
+template <>
+struct hash<Smart::SlotMapId> {
+	inline std::size_t operator()(const Smart::SlotMapId &id) const {
+		return std::hash<uint64_t>()((static_cast<uint64_t>(id.generation) << 32) | id.index);
+	}
+};
+
+} /* namespace std */
+
+#endif /* SMARTSOFT_INTERFACES_SMARTSLOTMAP_T_H_ */
@@ -94,6 +94,8 @@ enum StatusCode {
 	SMART_UNKNOWNCOMPONENT,
 	/// generic timeout status code
 	SMART_TIMEOUT,
+	/// used to indicate a request that has been rejected by the server's admission control
+	SMART_OVERLOADED,
 	///value=256 (all enumeration values <= SMART_STATUS indicate regular status codes)
 	SMART_STATUS          = 256,
 
@@ -170,6 +172,9 @@ inline std::string StatusCodeConversion(const StatusCode &code)
 	      case SMART_TIMEOUT:
 	        r = "STATUS: TIMEOUT";
 	        break;
+	      case SMART_OVERLOADED:
+	        r = "STATUS: OVERLOADED";
+	        break;
 	      default:
 	        r = "STATUS: unknown status code";
 	        break;
@@ -0,0 +1,146 @@
+//===================================================================================
+//
+//  Copyright (C) 2017 Alex Lotz, Dennis Stampfer, Matthias Lutz, Christian Schlegel
+//
+//        lotz@hs-ulm.de
+//        stampfer@hs-ulm.de
+//        lutz@hs-ulm.de
+//        schlegel@hs-ulm.de
+//
+//        Servicerobotik Ulm
+//        Christian Schlegel
+//        Ulm University of Applied Sciences
+//        Prittwitzstr. 10
+//        89075 Ulm
+//        Germany
+//
+//  This file is part of the SmartSoft Component-Developer C++ API.
+//
+//  Redistribution and use in source and binary forms, with or without modification,
+//  are permitted provided that the following conditions are met:
+//
+//  1. Redistributions of source code must retain the above copyright notice,
+//     this list of conditions and the following disclaimer.
+//
+//  2. Redistributions in binary form must reproduce the above copyright notice,
+//     this list of conditions and the following disclaimer in the documentation
+//     and/or other materials provided with the distribution.
+//
+//  3. Neither the name of the copyright holder nor the names of its contributors
+//     may be used to endorse or promote products derived from this software
+//     without specific prior written permission.
+//
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+//  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+//  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+//  IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+//  INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+//  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+//  DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+//  LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE
+//  OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+//  OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+//===================================================================================
+
+#ifndef SMARTSOFT_INTERFACES_SMARTTASKEXECUTIONBUDGET_H_
+#define SMARTSOFT_INTERFACES_SMARTTASKEXECUTIONBUDGET_H_
+
+#include <string>
+
+// C++11 chrono
+#include <chrono>
+
+#if defined(__unix__)
+#include <time.h>
+#include <unistd.h>
+#endif
+
+namespace Smart {
+
+/** The degradation policy of an IManagedTask that overran its execution budget.
+ *
+ *  In all cases the IManagedTask::on_budget_overrun() hook is called first.
+ *  The degradation is withdrawn step by step after TaskExecutionBudget::recoveryCycles
+ *  consecutive cycles within the budget.
+ */
+enum TaskOverloadPolicy {
+	/// only report the overrun (no degradation)
+	TASK_OVERLOAD_REPORT = 0,
+	/// double the prescale factor of the task's trigger (up to TaskExecutionBudget::maxPrescaleFactor)
+	TASK_OVERLOAD_RAISE_PRESCALE,
+	/// skip as many subsequent trigger cycles as the overrun took budgets
+	TASK_OVERLOAD_SKIP_CYCLES,
+	/// call IManagedTask::on_execute_degraded() instead of IManagedTask::on_execute()
+	TASK_OVERLOAD_DEGRADED_EXECUTE
+};
+
+/** global function used to convert a TaskOverloadPolicy into ASCII representation.
+ *
+ *  @param policy TaskOverloadPolicy
+ */
+inline std::string TaskOverloadPolicyString(const TaskOverloadPolicy &policy)
+{
+	if(TASK_OVERLOAD_REPORT == policy) return "TASK_OVERLOAD_REPORT";
+	else if(TASK_OVERLOAD_RAISE_PRESCALE == policy) return "TASK_OVERLOAD_RAISE_PRESCALE";
+	else if(TASK_OVERLOAD_SKIP_CYCLES == policy) return "TASK_OVERLOAD_SKIP_CYCLES";
+	else if(TASK_OVERLOAD_DEGRADED_EXECUTE == policy) return "TASK_OVERLOAD_DEGRADED_EXECUTE";
+	else return "NA";
+}
+
+/** The CPU-time budget of a single IManagedTask cycle.
+ *
+ *  A zero budget (the default) disables budget monitoring entirely.
+ */
+struct TaskExecutionBudget {
+	/// the maximum CPU time of the calling thread that a single on_execute() call may consume
+	std::chrono::nanoseconds budget;
+	/// the degradation policy applied on an overrun
+	TaskOverloadPolicy policy;
+	/// the upper limit for TASK_OVERLOAD_RAISE_PRESCALE
+	unsigned int maxPrescaleFactor;
+	/// the number of consecutive cycles within the budget after which one degradation step is withdrawn
+	unsigned int recoveryCycles;
+
+	/// Default constructor (budget monitoring disabled)
+	TaskExecutionBudget(const std::chrono::nanoseconds &budget=std::chrono::nanoseconds::zero(), const TaskOverloadPolicy &policy=TASK_OVERLOAD_REPORT)
+	:	budget(budget)
+	,	policy(policy)
+	,	maxPrescaleFactor(16)
+	,	recoveryCycles(10)
+	{  }
+};
+
+/** Reads the CPU time consumed by the calling thread so far.
+ *
+ *  Uses CLOCK_THREAD_CPUTIME_ID, so that preemption by other threads is not accounted
+ *  to the calling thread. There is no fallback to another clock, since budgets compared
+ *  against wall-clock time (or differences of two clocks) would be meaningless.
+ *
+ *  @param cpuTime is set to the CPU time of the calling thread (unchanged on failure)
+ *
+ *  @return true on success or false if the thread CPU-time clock is not available
+ */
+inline bool getThreadCpuTime(std::chrono::nanoseconds &cpuTime)
+{
+#if defined(_POSIX_THREAD_CPUTIME) && (_POSIX_THREAD_CPUTIME >= 0)
+	timespec ts;
+	if(clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts) == 0) {
+		cpuTime = std::chrono::seconds(ts.tv_sec) + std::chrono::nanoseconds(ts.tv_nsec);
+		return true;
+	}
+#endif
+	return false;
+}
+
+/** Returns true if the thread CPU-time clock (see getThreadCpuTime()) is available.
+ */
+inline bool isThreadCpuTimeSupported()
+{
+	std::chrono::nanoseconds cpu_time;
+	return getThreadCpuTime(cpu_time);
+}
+
+} /* namespace Smart */
+
+#endif /* SMARTSOFT_INTERFACES_SMARTTASKEXECUTIONBUDGET_H_ */
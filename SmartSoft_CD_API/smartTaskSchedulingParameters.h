@@ -0,0 +1,278 @@
+//===================================================================================
+//
+//  Copyright (C) 2017 Alex Lotz, Dennis Stampfer, Matthias Lutz, Christian Schlegel
+//
+//        lotz@hs-ulm.de
+//        stampfer@hs-ulm.de
+//        lutz@hs-ulm.de
+//        schlegel@hs-ulm.de
+//
+//        Servicerobotik Ulm
+//        Christian Schlegel
+//        Ulm University of Applied Sciences
+//        Prittwitzstr. 10
+//        89075 Ulm
+//        Germany
+//
+//  This file is part of the SmartSoft Component-Developer C++ API.
+//
+//  Redistribution and use in source and binary forms, with or without modification,
+//  are permitted provided that the following conditions are met:
+//
+//  1. Redistributions of source code must retain the above copyright notice,
+//     this list of conditions and the following disclaimer.
+//
+//  2. Redistributions in binary form must reproduce the above copyright notice,
+//     this list of conditions and the following disclaimer in the documentation
+//     and/or other materials provided with the distribution.
+//
+//  3. Neither the name of the copyright holder nor the names of its contributors
+//     may be used to endorse or promote products derived from this software
+//     without specific prior written permission.
+//
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+//  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+//  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+//  IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+//  INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+//  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+//  DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+//  LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE
+//  OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+//  OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+//===================================================================================
+
+#ifndef SMARTSOFT_INTERFACES_SMARTTASKSCHEDULINGPARAMETERS_H_
+#define SMARTSOFT_INTERFACES_SMARTTASKSCHEDULINGPARAMETERS_H_
+
+#include <string>
+#include <vector>
+#include <cstddef>
+
+// C++11 chrono
+#include <chrono>
+
+#include "smartStatusCode.h"
+
+#if defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#include <alloca.h>
+#include <cerrno>
+#include <cstring>
+#include <cstdint>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace Smart {
+
+/** The scheduling policy of a thread.
+ *
+ *  The policies correspond to the POSIX/Linux scheduling classes. Platforms
+ *  that do not support a certain policy return SMART_NOTALLOWED when
+ *  the parameters are applied.
+ */
+enum TaskSchedulingPolicy {
+	/// the platform's default time-sharing policy (e.g. SCHED_OTHER)
+	TASK_SCHED_DEFAULT  = 0,
+	/// fixed-priority first-in-first-out real-time policy (SCHED_FIFO)
+	TASK_SCHED_FIFO,
+	/// fixed-priority round-robin real-time policy (SCHED_RR)
+	TASK_SCHED_RR,
+	/// earliest-deadline-first policy using runtime, deadline and period (SCHED_DEADLINE)
+	TASK_SCHED_DEADLINE
+};
+
+/** global function used to convert a TaskSchedulingPolicy into ASCII representation.
+ *
+ *  @param policy TaskSchedulingPolicy
+ */
+inline std::string TaskSchedulingPolicyString(const TaskSchedulingPolicy &policy)
+{
+	if(TASK_SCHED_DEFAULT == policy) return "TASK_SCHED_DEFAULT";
+	else if(TASK_SCHED_FIFO == policy) return "TASK_SCHED_FIFO";
+	else if(TASK_SCHED_RR == policy) return "TASK_SCHED_RR";
+	else if(TASK_SCHED_DEADLINE == policy) return "TASK_SCHED_DEADLINE";
+	else return "NA";
+}
+
+/** Per-thread scheduling attributes.
+ *
+ *  An instance of this struct can be attached to an ITask (see ITask::set_scheduling_parameters()),
+ *  to the internal thread of an IActiveQueueInputHandlerDecorator, or to the dispatch thread of an
+ *  ITimerManager. A default-constructed instance leaves all thread attributes untouched.
+ */
+struct TaskSchedulingParameters {
+	/// the scheduling policy
+	TaskSchedulingPolicy policy;
+	/// the static priority used by TASK_SCHED_FIFO and TASK_SCHED_RR (ignored otherwise)
+	int priority;
+	/// the guaranteed CPU time per period used by TASK_SCHED_DEADLINE
+	std::chrono::nanoseconds runtime;
+	/// the relative deadline used by TASK_SCHED_DEADLINE
+	std::chrono::nanoseconds deadline;
+	/// the activation period used by TASK_SCHED_DEADLINE
+	std::chrono::nanoseconds period;
+	/// the CPU indices the thread is allowed to run on (an empty list allows all CPUs)
+	std::vector<unsigned int> cpuAffinity;
+	/// the thread name visible in system tools (an empty name keeps the default name)
+	std::string threadName;
+	/// the stack size in bytes (zero selects the platform's default stack size)
+	std::size_t stackSize;
+
+	/// Default constructor (leaves the thread attributes untouched)
+	TaskSchedulingParameters()
+	:	policy(TASK_SCHED_DEFAULT)
+	,	priority(0)
+	,	runtime(std::chrono::nanoseconds::zero())
+	,	deadline(std::chrono::nanoseconds::zero())
+	,	period(std::chrono::nanoseconds::zero())
+	,	stackSize(0)
+	{  }
+};
+
+/** Component-wide memory-locking attributes.
+ *
+ *  Real-time components typically lock all their pages into RAM and prefault
+ *  the stack before they start their tasks, so that no page-fault happens
+ *  within the time-critical code later on (see IComponent::lockMemory()).
+ */
+struct MemoryLockingParameters {
+	/// lock all currently mapped pages (MCL_CURRENT)
+	bool lockCurrent;
+	/// lock all pages mapped in the future (MCL_FUTURE)
+	bool lockFuture;
+	/// the number of stack bytes of the calling thread to prefault (zero disables prefaulting)
+	std::size_t stackPrefaultSize;
+
+	/// Default constructor (locks current and future pages and prefaults 512 KiB of the stack)
+	MemoryLockingParameters()
+	:	lockCurrent(true)
+	,	lockFuture(true)
+	,	stackPrefaultSize(512*1024)
+	{  }
+};
+
+#if defined(__linux__)
+namespace detail {
+	// SCHED_DEADLINE is only accessible via the sched_setattr syscall (not wrapped by older glibc versions)
+	struct sched_attr_t {
+		std::uint32_t size;
+		std::uint32_t sched_policy;
+		std::uint64_t sched_flags;
+		std::int32_t sched_nice;
+		std::uint32_t sched_priority;
+		std::uint64_t sched_runtime;
+		std::uint64_t sched_deadline;
+		std::uint64_t sched_period;
+	};
+
+	inline StatusCode errnoToStatus(const int &error) {
+		if(error == EPERM || error == EACCES) return SMART_NOTALLOWED;
+		return SMART_ERROR;
+	}
+} /* namespace detail */
+#endif
+
+/** Applies the scheduling parameters to the calling thread.
+ *
+ *  This function is meant to be called as the very first statement of a newly spawned thread.
+ *  The <b>stackSize</b> can not be changed for an already running thread and has to be
+ *  considered by the implementation that creates the thread (e.g. using pthread_attr_setstacksize()).
+ *
+ *  @param params the scheduling parameters to apply
+ *
+ *  @return status code
+ *    - SMART_OK         : all parameters have been applied
+ *    - SMART_NOTALLOWED : missing privileges (e.g. CAP_SYS_NICE) or parameters not supported on this platform
+ *    - SMART_ERROR      : invalid parameters (e.g. priority out of range)
+ */
+inline StatusCode applyThreadSchedulingParameters(const TaskSchedulingParameters &params)
+{
+#if defined(__linux__)
+	if(!params.threadName.empty()) {
+		// Linux restricts thread names to 15 characters (plus the terminating null)
+		if(pthread_setname_np(pthread_self(), params.threadName.substr(0,15).c_str()) != 0) {
+			return SMART_ERROR;
+		}
+	}
+
+	if(!params.cpuAffinity.empty()) {
+		cpu_set_t cpuset;
+		CPU_ZERO(&cpuset);
+		for(auto it=params.cpuAffinity.begin(); it!=params.cpuAffinity.end(); it++) {
+			if(*it >= CPU_SETSIZE) return SMART_ERROR;
+			CPU_SET(*it, &cpuset);
+		}
+		int error = pthread_setaffinity_np(pthread_self(), sizeof(cpu_set_t), &cpuset);
+		if(error != 0) return detail::errnoToStatus(error);
+	}
+
+	if(params.policy == TASK_SCHED_FIFO || params.policy == TASK_SCHED_RR) {
+		sched_param sp;
+		std::memset(&sp, 0, sizeof(sp));
+		sp.sched_priority = params.priority;
+		int error = pthread_setschedparam(pthread_self(), (params.policy==TASK_SCHED_FIFO)?SCHED_FIFO:SCHED_RR, &sp);
+		if(error != 0) return detail::errnoToStatus(error);
+	} else if(params.policy == TASK_SCHED_DEADLINE) {
+#if defined(SYS_sched_setattr)
+		detail::sched_attr_t attr;
+		std::memset(&attr, 0, sizeof(attr));
+		attr.size = sizeof(attr);
+		attr.sched_policy = 6; // SCHED_DEADLINE
+		attr.sched_runtime = params.runtime.count();
+		attr.sched_deadline = params.deadline.count();
+		attr.sched_period = params.period.count();
+		if(syscall(SYS_sched_setattr, 0, &attr, 0) != 0) return detail::errnoToStatus(errno);
+#else
+		return SMART_NOTALLOWED;
+#endif
+	}
+	return SMART_OK;
+#else
+	// no platform-specific support available (only the default parameters are accepted)
+	if(params.policy != TASK_SCHED_DEFAULT || !params.cpuAffinity.empty() || !params.threadName.empty()) {
+		return SMART_NOTALLOWED;
+	}
+	return SMART_OK;
+#endif
+}
+
+/** Locks the process memory and prefaults the stack of the calling thread.
+ *
+ *  @param params the memory-locking parameters
+ *
+ *  @return status code
+ *    - SMART_OK         : memory has been locked and the stack has been prefaulted
+ *    - SMART_NOTALLOWED : missing privileges (e.g. RLIMIT_MEMLOCK) or not supported on this platform
+ *    - SMART_ERROR      : something went wrong
+ */
+inline StatusCode lockProcessMemory(const MemoryLockingParameters &params)
+{
+#if defined(__linux__)
+	int flags = 0;
+	if(params.lockCurrent) flags |= MCL_CURRENT;
+	if(params.lockFuture) flags |= MCL_FUTURE;
+	if(flags != 0 && mlockall(flags) != 0) {
+		return detail::errnoToStatus(errno);
+	}
+	if(params.stackPrefaultSize > 0) {
+		// touch each page of the requested stack range once so that it is mapped (and locked) right now
+		volatile unsigned char *stack = static_cast<volatile unsigned char*>(alloca(params.stackPrefaultSize));
+		const long page_size = sysconf(_SC_PAGESIZE);
+		for(std::size_t i=0; i<params.stackPrefaultSize; i+=page_size) {
+			stack[i] = 0;
+		}
+	}
+	return SMART_OK;
+#else
+	return SMART_NOTALLOWED;
+#endif
+}
+
+} /* namespace Smart */
+
+#endif /* SMARTSOFT_INTERFACES_SMARTTASKSCHEDULINGPARAMETERS_H_ */
@@ -48,6 +48,7 @@
 
 #include <smartStatusCode.h>
 #include <smartPrescaleManager.h>
+#include <smartIVirtualClock.h>
 
 #include <map>
 
@@ -67,9 +68,59 @@ class TaskTriggerObserver {
 private:
 	bool trigger_cancelled;
 	bool signalled;
+	// true between a consumed trigger and the next call of waitOnTrigger()
+	bool executing;
 	std::mutex observer_mutex;
 	std::condition_variable_any trigger_cond_var;
 
+	// the virtual clock (if any) and the busy state of this observer at that clock
+	IVirtualClock *virtual_clock;
+	// true once the observer waited on its trigger (only then it participates in the virtual clock)
+	bool clock_joined;
+	bool busy;
+	bool timeout_expired;
+
+	// measures the timeouts of waitOnTrigger() in virtual time
+	class VirtualTimeoutHandler : public ITimerHandler {
+	private:
+		TaskTriggerObserver *observer;
+	public:
+		VirtualTimeoutHandler(TaskTriggerObserver *observer)
+		:	observer(observer)
+		{  }
+		virtual void timerExpired(const std::chrono::system_clock::time_point &) {
+			observer->virtualTimeout();
+		}
+		virtual void timerCancelled() {  }
+		virtual void timerDeleted() {  }
+	} timeout_handler;
+
+	// must be called with the observer_mutex locked
+	inline void setBusy(const bool &value) {
+		if(virtual_clock != 0 && clock_joined && busy != value) {
+			busy = value;
+			if(busy == true) {
+				virtual_clock->enterBusy();
+			} else {
+				virtual_clock->leaveBusy();
+			}
+		}
+	}
+
+	// returns true if the observer has not finished its previous trigger cycle yet
+	inline bool isCycleActive() {
+		std::unique_lock<std::mutex> lock(observer_mutex);
+		return signalled || executing;
+	}
+
+	inline void virtualTimeout() {
+		std::unique_lock<std::mutex> lock(observer_mutex);
+		timeout_expired = true;
+		// the timed-out task is busy before the virtual time can advance any further
+		this->setBusy(true);
+		trigger_cond_var.notify_all();
+	}
+
 protected:
 	TaskTriggerSubject *subject;
 
@@ -81,6 +132,7 @@ protected:
 	virtual void signalTrigger() {
 		std::unique_lock<std::mutex> lock(observer_mutex);
 		signalled = true;
+		this->setBusy(true);
 		trigger_cond_var.notify_all();
 	}
 
@@ -94,32 +146,93 @@ public:
 	TaskTriggerObserver(TaskTriggerSubject *subject, const unsigned int &prescaleFactor=1);
 	virtual ~TaskTriggerObserver();
 
+	/// changes the prescale factor of this observer at its current subject
+	void setPrescaleFactor(const unsigned int &prescaleFactor);
+
+	/// returns the prescale factor of this observer at its current subject (or 0 if not attached)
+	unsigned int getPrescaleFactor();
+
+	/** Uses the given virtual clock instead of the process-wide clock (see IVirtualClock)
+	 *
+	 *  Must not be called while another thread is within waitOnTrigger(timeout).
+	 *
+	 *  @param clock the virtual clock (0 to use the real time)
+	 */
+	void setVirtualClock(IVirtualClock *clock) {
+		std::unique_lock<std::mutex> lock(observer_mutex);
+		bool was_busy = busy;
+		this->setBusy(false);
+		virtual_clock = clock;
+		this->setBusy(was_busy);
+	}
+
 	virtual StatusCode waitOnTrigger() {
 		std::unique_lock<std::mutex> lock(observer_mutex);
-		if(subject == 0) return SMART_NOTACTIVATED;
+		executing = false;
+		clock_joined = true;
+		if(subject == 0) {
+			this->setBusy(false);
+			return SMART_NOTACTIVATED;
+		}
 		if(trigger_cancelled == true) {
+			this->setBusy(false);
 			return SMART_CANCELLED;
 		} else {
 			if(signalled == false) {
+				this->setBusy(false);
 				trigger_cond_var.wait(lock);
 			}
 			signalled = false;
+			executing = true;
+			this->setBusy(true);
 			return SMART_OK;
 		}
 	}
 
 	virtual StatusCode waitOnTrigger(const std::chrono::steady_clock::duration &timeout) {
 		std::unique_lock<std::mutex> lock(observer_mutex);
-		if(subject == 0) return SMART_NOTACTIVATED;
+		executing = false;
+		clock_joined = true;
+		if(subject == 0) {
+			this->setBusy(false);
+			return SMART_NOTACTIVATED;
+		}
 		if(trigger_cancelled == true) {
+			this->setBusy(false);
 			return SMART_CANCELLED;
 		} else {
-			if(signalled == false) {
+			if(signalled == false && virtual_clock != 0) {
+				// the timeout is measured by a timer of the virtual clock
+				ITimerManager *timer_manager = virtual_clock->getTimerManager();
+				timeout_expired = false;
+				ITimerManager::TimerId timeout_id = timer_manager->scheduleTimer(&timeout_handler, timeout);
+				if(timeout_id < 0) return SMART_ERROR;
+				this->setBusy(false);
+				while(signalled == false && timeout_expired == false && trigger_cancelled == false) {
+					trigger_cond_var.wait(lock);
+				}
+				if(timeout_expired == false) {
+					// the timeout upcall locks the observer_mutex
+					lock.unlock();
+					timer_manager->cancelTimer(timeout_id);
+					lock.lock();
+				}
+				if(signalled == false && timeout_expired == true) {
+					return SMART_TIMEOUT;
+				}
+				if(signalled == false) {
+					// woken up by cancelTrigger()
+					this->setBusy(false);
+					return SMART_CANCELLED;
+				}
+			} else if(signalled == false) {
 				if(trigger_cond_var.wait_for(lock, timeout)==std::cv_status::timeout) {
 					return SMART_TIMEOUT;
 				}
 			}
 			signalled = false;
+			executing = true;
+			this->setBusy(true);
 			return SMART_OK;
 		}
 	}
@@ -142,23 +255,51 @@ protected:
 		}
 	}
 
+	/** Signals a single observer (bypassing its prescale factor)
+	 *
+	 *  @param observer the observer to signal
+	 *
+	 *  @return true if the observer had not finished its previous trigger cycle yet (overrun)
+	 */
+	inline bool signal_observer(TaskTriggerObserver *observer) {
+		bool overrun = observer->isCycleActive();
+		observer->signalTrigger();
+		return overrun;
+	}
+
 public:
 	TaskTriggerSubject()
 	{ }
 	virtual ~TaskTriggerSubject()
 	{ }
 
-	void attach(TaskTriggerObserver *observer, const unsigned int &prescaleFactor=1) {
+	virtual void attach(TaskTriggerObserver *observer, const unsigned int &prescaleFactor=1) {
 		std::unique_lock<std::mutex> lock(subject_mutex);
 		observer->setSubject(this);
 		observers[observer] = prescaleFactor;
 	}
-	void detach(TaskTriggerObserver *observer) {
+	virtual void detach(TaskTriggerObserver *observer) {
 		std::unique_lock<std::mutex> lock(subject_mutex);
 		observer->setSubject(0);
 		observer->cancelTrigger();
 		observers.erase(observer);
 	}
+
+	virtual void setPrescaleFactor(TaskTriggerObserver *observer, const unsigned int &prescaleFactor) {
+		std::unique_lock<std::mutex> lock(subject_mutex);
+		auto it = observers.find(observer);
+		if(it != observers.end()) {
+			it->second.setPrescaleFactor(prescaleFactor);
+		}
+	}
+	virtual unsigned int getPrescaleFactor(TaskTriggerObserver *observer) {
+		std::unique_lock<std::mutex> lock(subject_mutex);
+		auto it = observers.find(observer);
+		if(it != observers.end()) {
+			return it->second.getPrescaleFactor();
+		}
+		return 0;
+	}
 };
 
 
@@ -167,6 +308,12 @@ inline TaskTriggerObserver::TaskTriggerObserver(TaskTriggerSubject *subject, con
 :	subject(subject)
 ,	trigger_cancelled(false)
 ,	signalled(false)
+,	executing(false)
+,	virtual_clock(IVirtualClock::getProcessClock())
+,	clock_joined(false)
+,	busy(false)
+,	timeout_expired(false)
+,	timeout_handler(this)
 {
 	if(subject != 0) {
 		this->subject->attach(this, prescaleFactor);
@@ -177,6 +324,33 @@ inline TaskTriggerObserver::~TaskTriggerObserver()
 	if(subject != 0) {
 		this->subject->detach(this);
 	}
+	std::unique_lock<std::mutex> lock(observer_mutex);
+	this->setBusy(false);
+}
+
+inline void TaskTriggerObserver::setPrescaleFactor(const unsigned int &prescaleFactor)
+{
+	TaskTriggerSubject *current_subject = 0;
+	{
+		// the subject locks its own mutex before it locks the observer_mutex (see trigger_all_tasks())
+		std::unique_lock<std::mutex> lock(observer_mutex);
+		current_subject = this->subject;
+	}
+	if(current_subject != 0) {
+		current_subject->setPrescaleFactor(this, prescaleFactor);
+	}
+}
+inline unsigned int TaskTriggerObserver::getPrescaleFactor()
+{
+	TaskTriggerSubject *current_subject = 0;
+	{
+		std::unique_lock<std::mutex> lock(observer_mutex);
+		current_subject = this->subject;
+	}
+	if(current_subject != 0) {
+		return current_subject->getPrescaleFactor(this);
+	}
+	return 0;
 }
 
 } /* namespace Smart */
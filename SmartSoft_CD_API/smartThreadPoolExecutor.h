@@ -0,0 +1,154 @@
+//===================================================================================
+//
+//  Copyright (C) 2017 Alex Lotz, Dennis Stampfer, Matthias Lutz, Christian Schlegel
+//
+//        lotz@hs-ulm.de
+//        stampfer@hs-ulm.de
+//        lutz@hs-ulm.de
+//        schlegel@hs-ulm.de
+//
+//        Servicerobotik Ulm
+//        Christian Schlegel
+//        Ulm University of Applied Sciences
+//        Prittwitzstr. 10
+//        89075 Ulm
+//        Germany
+//
+//  This file is part of the SmartSoft Component-Developer C++ API.
+//
+//  Redistribution and use in source and binary forms, with or without modification,
+//  are permitted provided that the following conditions are met:
+//
+//  1. Redistributions of source code must retain the above copyright notice,
+//     this list of conditions and the following disclaimer.
+//
+//  2. Redistributions in binary form must reproduce the above copyright notice,
+//     this list of conditions and the following disclaimer in the documentation
+//     and/or other materials provided with the distribution.
+//
+//  3. Neither the name of the copyright holder nor the names of its contributors
+//     may be used to endorse or promote products derived from this software
+//     without specific prior written permission.
+//
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+//  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+//  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+//  IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+//  INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+//  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+//  DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+//  LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE
+//  OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+//  OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+//===================================================================================
+
+#ifndef SMARTSOFT_INTERFACES_SMARTTHREADPOOLEXECUTOR_H_
+#define SMARTSOFT_INTERFACES_SMARTTHREADPOOLEXECUTOR_H_
+
+#include <deque>
+#include <vector>
+#include <algorithm>
+
+// C++11 includes
+#include <mutex>
+#include <thread>
+#include <condition_variable>
+
+#include "smartIExecutor.h"
+#include "smartTaskSchedulingParameters.h"
+
+namespace Smart {
+
+/** Reference implementation of the IExecutor interface based on a fixed pool of threads
+ *
+ *  Jobs are executed in FIFO order. With a single thread (the default) all jobs are
+ *  serialized, which frees the jobs from additional locking among each other.
+ */
+class ThreadPoolExecutor : public IExecutor {
+private:
+	std::mutex executor_mutex;
+	std::condition_variable executor_cond_var;
+	std::deque< std::function<void()> > jobs;
+	std::vector<std::thread> threads;
+	TaskSchedulingParameters scheduling_parameters;
+	bool stopped;
+
+	void worker_loop() {
+		applyThreadSchedulingParameters(scheduling_parameters);
+		std::unique_lock<std::mutex> lock(executor_mutex);
+		while(true) {
+			if(jobs.empty()) {
+				if(stopped) break;
+				executor_cond_var.wait(lock);
+				continue;
+			}
+			std::function<void()> job;
+			job.swap(jobs.front());
+			jobs.pop_front();
+			lock.unlock();
+			job();
+			lock.lock();
+		}
+	}
+
+public:
+	/** Default constructor (starts the worker threads)
+	 *
+	 *  @param num_threads the number of worker threads (at least one)
+	 *  @param params      the scheduling parameters applied by each worker thread
+	 */
+	ThreadPoolExecutor(const unsigned int &num_threads=1, const TaskSchedulingParameters &params=TaskSchedulingParameters())
+	:	scheduling_parameters(params)
+	,	stopped(false)
+	{
+		for(unsigned int i=0; i<std::max(num_threads, 1u); ++i) {
+			threads.push_back(std::thread(&ThreadPoolExecutor::worker_loop, this));
+		}
+	}
+
+	/** Default destructor
+	 *
+	 *  Calls stop(), i.e. all jobs queued so far are executed before the destructor returns.
+	 */
+	virtual ~ThreadPoolExecutor()
+	{
+		this->stop();
+	}
+
+	virtual StatusCode post(const std::function<void()> &job) {
+		std::unique_lock<std::mutex> lock(executor_mutex);
+		if(stopped) return SMART_CANCELLED;
+		jobs.push_back(job);
+		executor_cond_var.notify_one();
+		return SMART_OK;
+	}
+
+	/** Rejects further jobs, executes the already queued jobs and joins the worker threads
+	 *
+	 *  Must not be called from within a job.
+	 */
+	void stop() {
+		std::vector<std::thread> stopped_threads;
+		{
+			std::unique_lock<std::mutex> lock(executor_mutex);
+			stopped = true;
+			stopped_threads.swap(threads);
+			executor_cond_var.notify_all();
+		}
+		for(auto it=stopped_threads.begin(); it!=stopped_threads.end(); it++) {
+			if(it->joinable()) it->join();
+		}
+	}
+
+	/** Returns the number of queued jobs that have not been started yet
+	 */
+	size_t getPendingJobs() {
+		std::unique_lock<std::mutex> lock(executor_mutex);
+		return jobs.size();
+	}
+};
+
+} /* namespace Smart */
+
+#endif /* SMARTSOFT_INTERFACES_SMARTTHREADPOOLEXECUTOR_H_ */
@@ -46,15 +46,44 @@
 #ifndef SMARTSOFT_INTERFACES_SMARTTIMEDTASKTRIGGER_H_
 #define SMARTSOFT_INTERFACES_SMARTTIMEDTASKTRIGGER_H_
 
-#include "smartITimerHandler.h"
+#include <mutex>
+
+#include "smartITimerManager.h"
 #include "smartTaskTriggerObserver.h"
 
 namespace Smart {
 
+class TimedTaskTrigger;
+
+/** Interface of classes that schedule the timers of TimedTaskTrigger instances and keep references
+ *  to them (see TimedTaskTriggerScheduler), so that a trigger can deregister itself when it is stopped
+ */
+class ITimedTaskTriggerOwner {
+public:
+	ITimedTaskTriggerOwner() { }
+	virtual ~ITimedTaskTriggerOwner() { }
+
+	/// removes all references to the trigger and cancels its timers (called by TimedTaskTrigger::stop())
+	virtual void releaseTrigger(TimedTaskTrigger *trigger) = 0;
+};
+
+/** Triggers the attached tasks on each expiry of its timer
+ *
+ *  A timer manager only keeps a plain pointer to the trigger (see ITimerHandler), therefore the trigger
+ *  records the timer manager that schedules it: either the one given in the constructor (used by start())
+ *  or the one of its owner (e.g. a TimedTaskTriggerScheduler). stop() and the destructor cancel all timers
+ *  of the trigger and release the owner. Derived classes that overload the upcalls have to call stop()
+ *  within their own destructor, before their state is destroyed.
+ */
 class TimedTaskTrigger
 :	public ITimerHandler
 ,	public TaskTriggerSubject
 {
+private:
+	std::mutex registration_mutex;
+	ITimerManager *timer_manager;
+	ITimedTaskTriggerOwner *timer_owner;
+
 protected:
 	virtual void timerExpired(const std::chrono::system_clock::time_point &abs_time) {
 		this->trigger_all_tasks();
@@ -63,10 +92,75 @@ protected:
 	virtual void timerCancelled() { }
 	virtual void timerDeleted() { }
 public:
-	TimedTaskTrigger()
+	/** Default constructor
+	 *
+	 *  @param timerManager the timer manager used by start() (can be 0 if the trigger is scheduled by an owner)
+	 */
+	TimedTaskTrigger(ITimerManager *timerManager=0)
+	:	timer_manager(timerManager)
+	,	timer_owner(0)
 	{ }
+
+	/// Default destructor (cancels all timers of the trigger, see stop())
 	virtual ~TimedTaskTrigger()
-	{ }
+	{
+		this->stop();
+	}
+
+	/** (Re)schedules the timer of the trigger with the recorded timer manager
+	 *
+	 *  @param first_time the time until the first expiry
+	 *  @param interval the period of the timer (zero for a one-shot timer)
+	 *
+	 *  @return 0 on success or -1 on failure (e.g. no timer manager or the trigger is scheduled by an owner)
+	 */
+	int start(const std::chrono::steady_clock::duration &first_time, const std::chrono::steady_clock::duration &interval=std::chrono::steady_clock::duration::zero()) {
+		ITimerManager *manager = 0;
+		{
+			std::unique_lock<std::mutex> lock(registration_mutex);
+			if(timer_manager == 0 || timer_owner != 0) return -1;
+			manager = timer_manager;
+		}
+		manager->cancelTimersOf(this);
+		return (manager->scheduleTimer(this, first_time, interval) < 0)? -1 : 0;
+	}
+
+	/** Cancels all timers of the trigger and releases its owner
+	 *
+	 *  Waits for upcalls of the trigger that are executed by other threads, so no upcall reaches
+	 *  the trigger after this method returned.
+	 */
+	void stop() {
+		ITimerManager *manager = 0;
+		ITimedTaskTriggerOwner *owner = 0;
+		{
+			std::unique_lock<std::mutex> lock(registration_mutex);
+			manager = timer_manager;
+			owner = timer_owner;
+			timer_owner = 0;
+		}
+		// the owner's and the manager's locks are never taken while the registration_mutex is held
+		if(owner != 0) owner->releaseTrigger(this);
+		if(manager != 0) manager->cancelTimersOf(this);
+	}
+
+	/** Records the owner that schedules the timers of this trigger with the given timer manager
+	 *
+	 *  @return 0 on success or -1 if the trigger already has another owner
+	 */
+	int setTimerOwner(ITimedTaskTriggerOwner *owner, ITimerManager *manager) {
+		std::unique_lock<std::mutex> lock(registration_mutex);
+		if(owner == 0 || manager == 0 || (timer_owner != 0 && timer_owner != owner)) return -1;
+		timer_owner = owner;
+		timer_manager = manager;
+		return 0;
+	}
+
+	/// removes the given owner again (the owner is responsible for cancelling the timers it scheduled)
+	void resetTimerOwner(ITimedTaskTriggerOwner *owner) {
+		std::unique_lock<std::mutex> lock(registration_mutex);
+		if(timer_owner == owner) timer_owner = 0;
+	}
 };
 
 } /* namespace Smart */
@@ -0,0 +1,370 @@
+//===================================================================================
+//
+//  Copyright (C) 2017 Alex Lotz, Dennis Stampfer, Matthias Lutz, Christian Schlegel
+//
+//        lotz@hs-ulm.de
+//        stampfer@hs-ulm.de
+//        lutz@hs-ulm.de
+//        schlegel@hs-ulm.de
+//
+//        Servicerobotik Ulm
+//        Christian Schlegel
+//        Ulm University of Applied Sciences
+//        Prittwitzstr. 10
+//        89075 Ulm
+//        Germany
+//
+//  This file is part of the SmartSoft Component-Developer C++ API.
+//
+//  Redistribution and use in source and binary forms, with or without modification,
+//  are permitted provided that the following conditions are met:
+//
+//  1. Redistributions of source code must retain the above copyright notice,
+//     this list of conditions and the following disclaimer.
+//
+//  2. Redistributions in binary form must reproduce the above copyright notice,
+//     this list of conditions and the following disclaimer in the documentation
+//     and/or other materials provided with the distribution.
+//
+//  3. Neither the name of the copyright holder nor the names of its contributors
+//     may be used to endorse or promote products derived from this software
+//     without specific prior written permission.
+//
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+//  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+//  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+//  IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+//  INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+//  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+//  DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+//  LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE
+//  OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+//  OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+//===================================================================================
+
+#ifndef SMARTSOFT_INTERFACES_SMARTTIMEDTASKTRIGGERSCHEDULER_H_
+#define SMARTSOFT_INTERFACES_SMARTTIMEDTASKTRIGGERSCHEDULER_H_
+
+#include <map>
+#include <vector>
+#include <algorithm>
+
+// C++11 includes
+#include <chrono>
+#include <mutex>
+
+#include "smartITimerManager.h"
+#include "smartIVirtualClock.h"
+#include "smartTimedTaskTrigger.h"
+
+namespace Smart {
+
+/** Schedules periodic TimedTaskTrigger instances with staggered phases
+ *
+ *  If several triggers with the same (or harmonic) periods are scheduled at the same time,
+ *  all of them fire within the same millisecond, which causes a CPU load spike and bad tail
+ *  latencies once per period. This scheduler assigns a phase offset (relative to a common
+ *  origin) to each trigger such that the estimated execution costs of the triggered tasks
+ *  (e.g. their TaskExecutionBudget) are spread evenly across the periods.
+ *
+ *  Internally a load profile over the (capped) hyperperiod of all registered periods is
+ *  maintained in slots of the given resolution. A new trigger gets the phase that results
+ *  in the smallest peak load (ties are broken by the smallest accumulated load and then by
+ *  the earliest phase). The phases of already running triggers are only changed by rebalance().
+ *  Triggers that must stay aligned with other activities can be pinned to an explicit phase,
+ *  which is taken into account in the load profile as well.
+ *
+ *  The scheduler registers itself as the owner of its triggers, so a trigger that is stopped or
+ *  destroyed is removed from the scheduler automatically (see TimedTaskTrigger::stop()).
+ */
+class TimedTaskTriggerScheduler : public ITimedTaskTriggerOwner {
+private:
+	// the maximum number of slots of the load profile
+	enum { MAX_PROFILE_SLOTS = 1 << 16 };
+
+	struct Registration {
+		// period and phase in slots, estimated cost in nanoseconds
+		long period;
+		long phase;
+		long long cost;
+		bool pinned;
+		// true if the registration is part of the load profile
+		bool placed;
+		ITimerManager::TimerId timer_id;
+		// the order of registration (breaks ties between equal costs in rebalance())
+		unsigned long sequence;
+	};
+
+	std::mutex scheduler_mutex;
+	ITimerManager *timer_manager;
+	IVirtualClock *virtual_clock;
+	std::chrono::steady_clock::duration slot;
+	std::chrono::steady_clock::time_point origin;
+	std::map<TimedTaskTrigger*,Registration> registrations;
+	unsigned long next_sequence;
+	// the estimated load per slot (in nanoseconds) over the hyperperiod
+	std::vector<long long> load;
+
+	static inline long gcd(long a, long b) {
+		while(b != 0) {
+			long t = a % b;
+			a = b;
+			b = t;
+		}
+		return a;
+	}
+
+	inline std::chrono::steady_clock::time_point now() const {
+		return (virtual_clock != 0)? virtual_clock->now() : std::chrono::steady_clock::now();
+	}
+
+	inline long toSlots(const std::chrono::steady_clock::duration &duration) const {
+		return static_cast<long>(duration / slot);
+	}
+
+	// calls the functor for each slot occupied by the given placement with the load of this slot
+	template <typename Functor>
+	inline void forEachSlot(const long &period, const long &phase, const long long &cost, Functor functor) const {
+		const long long slot_cost = std::chrono::duration_cast<std::chrono::nanoseconds>(slot).count();
+		const long hyperperiod = static_cast<long>(load.size());
+		// periods beyond the (capped) hyperperiod are wrapped into the profile
+		for(long start = phase % hyperperiod; start < hyperperiod; start += period) {
+			long long remaining = cost;
+			long index = start;
+			do {
+				// zero-cost triggers are spread by count
+				long long weight = (cost == 0)? 1 : std::min(remaining, slot_cost);
+				functor(index % hyperperiod, weight);
+				remaining -= weight;
+				index++;
+			} while(remaining > 0 && index < start + period);
+		}
+	}
+
+	void rebuildProfile(const long &additional_period) {
+		long long hyperperiod = std::max(additional_period, 1L);
+		for(auto it=registrations.begin(); it!=registrations.end(); it++) {
+			hyperperiod = hyperperiod / gcd(static_cast<long>(hyperperiod), it->second.period) * it->second.period;
+			if(hyperperiod > MAX_PROFILE_SLOTS) {
+				// the profile is an approximation for non-harmonic periods with a large hyperperiod
+				hyperperiod = MAX_PROFILE_SLOTS;
+				break;
+			}
+		}
+		load.assign(static_cast<std::size_t>(hyperperiod), 0);
+		for(auto it=registrations.begin(); it!=registrations.end(); it++) {
+			if(it->second.placed == true) this->addLoad(it->second);
+		}
+	}
+
+	inline void addLoad(const Registration &registration) {
+		std::vector<long long> &profile = load;
+		this->forEachSlot(registration.period, registration.phase, registration.cost,
+			[&profile](const long &index, const long long &weight) { profile[index] += weight; });
+	}
+
+	long findPhase(const long &period, const long long &cost) const {
+		long best_phase = 0;
+		long long best_peak = -1;
+		long long best_sum = 0;
+		for(long phase = 0; phase < period && phase < static_cast<long>(load.size()); ++phase) {
+			long long peak = 0;
+			long long sum = 0;
+			const std::vector<long long> &profile = load;
+			this->forEachSlot(period, phase, cost,
+				[&profile,&peak,&sum](const long &index, const long long &weight) {
+					peak = std::max(peak, profile[index] + weight);
+					sum += profile[index];
+				});
+			if(best_peak < 0 || peak < best_peak || (peak == best_peak && sum < best_sum)) {
+				best_phase = phase;
+				best_peak = peak;
+				best_sum = sum;
+			}
+		}
+		return best_phase;
+	}
+
+	// schedules the timer of the trigger such that it expires at origin + phase + k*period
+	ITimerManager::TimerId scheduleRegistration(TimedTaskTrigger *trigger, const Registration &registration) {
+		const std::chrono::steady_clock::duration period = slot * registration.period;
+		const std::chrono::steady_clock::time_point first_phase = origin + slot * registration.phase;
+		const std::chrono::steady_clock::time_point current = this->now();
+		std::chrono::steady_clock::time_point next = first_phase;
+		if(next < current) {
+			next += ((current - first_phase) / period) * period;
+			if(next < current) next += period;
+		}
+		return timer_manager->scheduleTimer(trigger, next - current, period);
+	}
+
+	ITimerManager::TimerId addRegistration(TimedTaskTrigger *trigger, const std::chrono::steady_clock::duration &period, const long long &cost, const bool &pinned, const std::chrono::steady_clock::duration &phase) {
+		std::unique_lock<std::mutex> lock(scheduler_mutex);
+		if(trigger == 0 || registrations.find(trigger) != registrations.end()) return -1;
+		if(trigger->setTimerOwner(this, timer_manager) != 0) return -1;
+		Registration registration;
+		registration.period = this->toSlots(period);
+		if(registration.period <= 0 || cost < 0) {
+			trigger->resetTimerOwner(this);
+			return -1;
+		}
+		registration.cost = cost;
+		registration.pinned = pinned;
+		registration.placed = false;
+		registration.timer_id = -1;
+		registration.sequence = next_sequence++;
+		this->rebuildProfile(registration.period);
+		if(pinned == true) {
+			registration.phase = this->toSlots(phase) % registration.period;
+			if(registration.phase < 0) registration.phase += registration.period;
+		} else {
+			registration.phase = this->findPhase(registration.period, registration.cost);
+		}
+		registration.timer_id = this->scheduleRegistration(trigger, registration);
+		if(registration.timer_id < 0) {
+			trigger->resetTimerOwner(this);
+			return -1;
+		}
+		registration.placed = true;
+		registrations[trigger] = registration;
+		this->addLoad(registration);
+		return registration.timer_id;
+	}
+
+public:
+	/** Default constructor
+	 *
+	 *  The phases are relative to the construction time of the scheduler (measured with the
+	 *  process-wide IVirtualClock if one is installed).
+	 *
+	 *  @param timer_manager the timer manager used to schedule the triggers
+	 *  @param resolution the resolution of the phases (and of the load profile)
+	 */
+	TimedTaskTriggerScheduler(ITimerManager *timer_manager, const std::chrono::steady_clock::duration &resolution=std::chrono::milliseconds(1))
+	:	timer_manager(timer_manager)
+	,	virtual_clock(IVirtualClock::getProcessClock())
+	,	slot(resolution > std::chrono::steady_clock::duration::zero()? resolution : std::chrono::steady_clock::duration(1))
+	,	origin(this->now())
+	,	next_sequence(0)
+	{  }
+
+	/// Default destructor (cancels all triggers of this scheduler)
+	virtual ~TimedTaskTriggerScheduler()
+	{
+		std::unique_lock<std::mutex> lock(scheduler_mutex);
+		for(auto it=registrations.begin(); it!=registrations.end(); it++) {
+			timer_manager->cancelTimer(it->second.timer_id);
+			it->first->resetTimerOwner(this);
+		}
+	}
+
+	/** Schedules a periodic trigger with an automatically assigned phase
+	 *
+	 *  @param trigger the trigger (each trigger can only be added once)
+	 *  @param period the period of the trigger
+	 *  @param estimated_cost the estimated execution time of the tasks triggered per period
+	 *
+	 *  @return the id of the trigger's timer or -1 on failure
+	 */
+	ITimerManager::TimerId addTrigger(TimedTaskTrigger *trigger, const std::chrono::steady_clock::duration &period, const std::chrono::steady_clock::duration &estimated_cost=std::chrono::steady_clock::duration::zero()) {
+		return this->addRegistration(trigger, period, std::chrono::duration_cast<std::chrono::nanoseconds>(estimated_cost).count(), false, std::chrono::steady_clock::duration::zero());
+	}
+
+	/** Schedules a periodic trigger at an explicit phase
+	 *
+	 *  @param trigger the trigger (each trigger can only be added once)
+	 *  @param period the period of the trigger
+	 *  @param phase the offset of the expiries relative to the common origin (modulo the period)
+	 *  @param estimated_cost the estimated execution time of the tasks triggered per period
+	 *
+	 *  @return the id of the trigger's timer or -1 on failure
+	 */
+	ITimerManager::TimerId addPinnedTrigger(TimedTaskTrigger *trigger, const std::chrono::steady_clock::duration &period, const std::chrono::steady_clock::duration &phase, const std::chrono::steady_clock::duration &estimated_cost=std::chrono::steady_clock::duration::zero()) {
+		return this->addRegistration(trigger, period, std::chrono::duration_cast<std::chrono::nanoseconds>(estimated_cost).count(), true, phase);
+	}
+
+	/** Cancels and removes a trigger
+	 *
+	 *  @return 0 on success or -1 if the trigger is unknown
+	 */
+	int removeTrigger(TimedTaskTrigger *trigger) {
+		std::unique_lock<std::mutex> lock(scheduler_mutex);
+		auto it = registrations.find(trigger);
+		if(it == registrations.end()) return -1;
+		timer_manager->cancelTimer(it->second.timer_id);
+		trigger->resetTimerOwner(this);
+		registrations.erase(it);
+		this->rebuildProfile(1);
+		return 0;
+	}
+
+	/// removes a trigger that is stopped or destroyed (see TimedTaskTrigger::stop())
+	virtual void releaseTrigger(TimedTaskTrigger *trigger) {
+		this->removeTrigger(trigger);
+	}
+
+	/** Returns the phase assigned to a trigger
+	 *
+	 *  @return 0 on success or -1 if the trigger is unknown
+	 */
+	int getPhase(TimedTaskTrigger *trigger, std::chrono::steady_clock::duration &phase) {
+		std::unique_lock<std::mutex> lock(scheduler_mutex);
+		auto it = registrations.find(trigger);
+		if(it == registrations.end()) return -1;
+		phase = slot * it->second.phase;
+		return 0;
+	}
+
+	/** Reassigns the phases of all (not pinned) triggers
+	 *
+	 *  The triggers are placed again in the order of decreasing estimated costs (triggers
+	 *  with equal costs in the order of their registration), which usually results in a
+	 *  flatter load profile than the incremental assignment. The timers of triggers whose
+	 *  phase changes are rescheduled; the old timer is only cancelled once the new one has
+	 *  been scheduled, so a trigger whose timer can not be rescheduled keeps its old phase.
+	 *
+	 *  @return 0 on success or -1 if a timer could not be rescheduled
+	 */
+	int rebalance() {
+		typedef std::map<TimedTaskTrigger*,Registration>::iterator RegistrationIterator;
+		std::unique_lock<std::mutex> lock(scheduler_mutex);
+		std::vector<RegistrationIterator> order;
+		for(auto it=registrations.begin(); it!=registrations.end(); it++) {
+			if(it->second.pinned == false) {
+				order.push_back(it);
+				// only the pinned triggers remain in the profile for now
+				it->second.placed = false;
+			}
+		}
+		std::sort(order.begin(), order.end(), [](const RegistrationIterator &a, const RegistrationIterator &b) {
+			if(a->second.cost != b->second.cost) return a->second.cost > b->second.cost;
+			return a->second.sequence < b->second.sequence;
+		});
+		this->rebuildProfile(1);
+		int result = 0;
+		for(auto it=order.begin(); it!=order.end(); it++) {
+			Registration &registration = (*it)->second;
+			long phase = this->findPhase(registration.period, registration.cost);
+			if(phase != registration.phase) {
+				Registration moved = registration;
+				moved.phase = phase;
+				moved.timer_id = this->scheduleRegistration((*it)->first, moved);
+				if(moved.timer_id < 0) {
+					// keep the old timer (and phase)
+					result = -1;
+				} else {
+					timer_manager->cancelTimer(registration.timer_id);
+					registration = moved;
+				}
+			}
+			registration.placed = true;
+			this->addLoad(registration);
+		}
+		return result;
+	}
+};
+
+} /* namespace Smart */
+
+#endif /* SMARTSOFT_INTERFACES_SMARTTIMEDTASKTRIGGERSCHEDULER_H_ */
@@ -0,0 +1,223 @@
+//===================================================================================
+//
+//  Copyright (C) 2017 Alex Lotz, Dennis Stampfer, Matthias Lutz, Christian Schlegel
+//
+//        lotz@hs-ulm.de
+//        stampfer@hs-ulm.de
+//        lutz@hs-ulm.de
+//        schlegel@hs-ulm.de
+//
+//        Servicerobotik Ulm
+//        Christian Schlegel
+//        Ulm University of Applied Sciences
+//        Prittwitzstr. 10
+//        89075 Ulm
+//        Germany
+//
+//  This file is part of the SmartSoft Component-Developer C++ API.
+//
+//  Redistribution and use in source and binary forms, with or without modification,
+//  are permitted provided that the following conditions are met:
+//
+//  1. Redistributions of source code must retain the above copyright notice,
+//     this list of conditions and the following disclaimer.
+//
+//  2. Redistributions in binary form must reproduce the above copyright notice,
+//     this list of conditions and the following disclaimer in the documentation
+//     and/or other materials provided with the distribution.
+//
+//  3. Neither the name of the copyright holder nor the names of its contributors
+//     may be used to endorse or promote products derived from this software
+//     without specific prior written permission.
+//
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+//  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+//  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+//  IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+//  INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+//  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+//  DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+//  LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE
+//  OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+//  OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+//===================================================================================
+
+#ifndef SMARTSOFT_INTERFACES_SMARTTIMERHISTOGRAM_H_
+#define SMARTSOFT_INTERFACES_SMARTTIMERHISTOGRAM_H_
+
+#include <cstddef>
+
+// C++11 chrono
+#include <chrono>
+
+namespace Smart {
+
+/** A fixed-size histogram of durations with log-linear buckets
+ *
+ *  Durations are counted in microseconds. Each power of two [2^k, 2^(k+1)) is divided into
+ *  SUB_BUCKETS linear sub-buckets (durations below SUB_BUCKETS microseconds have a bucket per
+ *  microsecond) and the last bucket additionally counts all longer durations. Thus the width
+ *  of a bucket is at most 1/SUB_BUCKETS of its lower bound. Adding a sample costs a few
+ *  instructions and never allocates, so that the histogram can be updated from within
+ *  time-critical dispatching code. Percentiles are interpolated linearly within their bucket.
+ */
+class TimerHistogram {
+public:
+	typedef std::chrono::steady_clock::duration Duration;
+
+	enum {
+		SUB_BUCKET_BITS = 2,
+		SUB_BUCKETS = 1 << SUB_BUCKET_BITS,
+		NUM_BUCKETS = 32 * SUB_BUCKETS
+	};
+
+private:
+	unsigned long buckets[NUM_BUCKETS];
+	unsigned long count;
+	Duration total;
+	Duration max;
+
+	static inline std::size_t bucketOf(const Duration &value) {
+		unsigned long long usec = std::chrono::duration_cast<std::chrono::microseconds>(value).count();
+		if(usec < SUB_BUCKETS) return static_cast<std::size_t>(usec);
+		// the position of the most significant bit selects the power of two
+		std::size_t msb = 0;
+		for(unsigned long long v = usec; v > 1; v >>= 1) msb++;
+		const std::size_t octave = msb - SUB_BUCKET_BITS + 1;
+		const std::size_t index = octave * SUB_BUCKETS + static_cast<std::size_t>(usec >> (msb - SUB_BUCKET_BITS)) - SUB_BUCKETS;
+		return (index < NUM_BUCKETS)? index : NUM_BUCKETS-1;
+	}
+
+	static inline long long lowerMicroseconds(const std::size_t &bucket) {
+		if(bucket < SUB_BUCKETS) return static_cast<long long>(bucket);
+		const std::size_t octave = bucket / SUB_BUCKETS;
+		return static_cast<long long>(SUB_BUCKETS + bucket % SUB_BUCKETS) << (octave - 1);
+	}
+
+public:
+	TimerHistogram()
+	{
+		this->reset();
+	}
+
+	/// removes all samples
+	inline void reset() {
+		for(std::size_t i=0; i<NUM_BUCKETS; ++i) buckets[i] = 0;
+		count = 0;
+		total = Duration::zero();
+		max = Duration::zero();
+	}
+
+	/// adds a sample (negative durations are counted as zero)
+	inline void add(const Duration &value) {
+		Duration sample = (value > Duration::zero())? value : Duration::zero();
+		buckets[bucketOf(sample)]++;
+		count++;
+		total += sample;
+		if(sample > max) max = sample;
+	}
+
+	/// adds all samples of another histogram
+	inline void merge(const TimerHistogram &other) {
+		for(std::size_t i=0; i<NUM_BUCKETS; ++i) buckets[i] += other.buckets[i];
+		count += other.count;
+		total += other.total;
+		if(other.max > max) max = other.max;
+	}
+
+	/// returns the number of samples
+	inline unsigned long getCount() const {
+		return count;
+	}
+
+	/// returns the largest sample
+	inline Duration getMax() const {
+		return max;
+	}
+
+	/// returns the mean of all samples
+	inline Duration getMean() const {
+		if(count == 0) return Duration::zero();
+		return total / static_cast<Duration::rep>(count);
+	}
+
+	/// returns the number of samples in the given bucket
+	inline unsigned long getBucketCount(const std::size_t &bucket) const {
+		return (bucket < NUM_BUCKETS)? buckets[bucket] : 0;
+	}
+
+	/// returns the (inclusive) lower bound of the given bucket
+	static inline Duration getBucketLowerBound(const std::size_t &bucket) {
+		return std::chrono::duration_cast<Duration>(std::chrono::microseconds(lowerMicroseconds(bucket)));
+	}
+
+	/// returns the (exclusive) upper bound of the given bucket (the last bucket is unbounded)
+	static inline Duration getBucketUpperBound(const std::size_t &bucket) {
+		if(bucket >= NUM_BUCKETS-1) return Duration::max();
+		return getBucketLowerBound(bucket + 1);
+	}
+
+	/** Returns the given percentile of all samples
+	 *
+	 *  The percentile is interpolated linearly between the bounds of the bucket that contains
+	 *  it (according to its rank within the bucket), where the upper bound is limited to the
+	 *  largest sample. The error is thus at most the width of the bucket.
+	 *
+	 *  @param percentile the percentile in the range [0,1] (e.g. 0.99)
+	 *
+	 *  @return the interpolated percentile (at most the largest sample)
+	 */
+	Duration getPercentile(const double &percentile) const {
+		if(count == 0) return Duration::zero();
+		unsigned long rank = static_cast<unsigned long>(percentile * count + 0.5);
+		if(rank == 0) rank = 1;
+		if(rank > count) rank = count;
+		unsigned long accumulated = 0;
+		for(std::size_t i=0; i<NUM_BUCKETS; ++i) {
+			if(buckets[i] == 0 || accumulated + buckets[i] < rank) {
+				accumulated += buckets[i];
+				continue;
+			}
+			const Duration lower = getBucketLowerBound(i);
+			Duration upper = getBucketUpperBound(i);
+			if(upper > max) upper = max;
+			if(upper <= lower) return (lower < max)? lower : max;
+			const double fraction = static_cast<double>(rank - accumulated) / static_cast<double>(buckets[i]);
+			return lower + std::chrono::duration_cast<Duration>((upper - lower) * fraction);
+		}
+		return max;
+	}
+};
+
+/// the histograms of the timing of timer upcalls (see ITimerManager::getLatenessHistograms())
+struct TimerLatenessHistograms {
+	/// the time between the scheduled expiry and the start of the upcall
+	TimerHistogram lateness;
+	/// the deviation of the lateness between consecutive expiries of the same periodic timer
+	TimerHistogram jitter;
+	/// the duration of the upcalls
+	TimerHistogram handlerRuntime;
+};
+
+/** Observer interface to be informed about timer upcalls that are too late
+ *
+ *  @see ITimerManager::setLatenessWarning()
+ */
+class ITimerLatenessObserver {
+public:
+	virtual ~ITimerLatenessObserver() {  }
+
+	/** Called from a dispatching thread (outside of any timer-manager lock) when
+	 *  the monitored percentile of the lateness exceeded the threshold within the
+	 *  last observation window
+	 *
+	 *  @param lateness the percentile of the lateness within the last window
+	 *  @param threshold the configured threshold
+	 */
+	virtual void latenessThresholdExceeded(const std::chrono::steady_clock::duration &lateness, const std::chrono::steady_clock::duration &threshold) = 0;
+};
+
+} /* namespace Smart */
+
+#endif /* SMARTSOFT_INTERFACES_SMARTTIMERHISTOGRAM_H_ */
@@ -0,0 +1,602 @@
+//===================================================================================
+//
+//  Copyright (C) 2017 Alex Lotz, Dennis Stampfer, Matthias Lutz, Christian Schlegel
+//
+//        lotz@hs-ulm.de
+//        stampfer@hs-ulm.de
+//        lutz@hs-ulm.de
+//        schlegel@hs-ulm.de
+//
+//        Servicerobotik Ulm
+//        Christian Schlegel
+//        Ulm University of Applied Sciences
+//        Prittwitzstr. 10
+//        89075 Ulm
+//        Germany
+//
+//  This file is part of the SmartSoft Component-Developer C++ API.
+//
+//  Redistribution and use in source and binary forms, with or without modification,
+//  are permitted provided that the following conditions are met:
+//
+//  1. Redistributions of source code must retain the above copyright notice,
+//     this list of conditions and the following disclaimer.
+//
+//  2. Redistributions in binary form must reproduce the above copyright notice,
+//     this list of conditions and the following disclaimer in the documentation
+//     and/or other materials provided with the distribution.
+//
+//  3. Neither the name of the copyright holder nor the names of its contributors
+//     may be used to endorse or promote products derived from this software
+//     without specific prior written permission.
+//
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+//  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+//  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+//  IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+//  INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+//  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+//  DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+//  LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE
+//  OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+//  OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+//===================================================================================
+
+#ifndef SMARTSOFT_INTERFACES_SMARTTIMERMANAGERBASE_H_
+#define SMARTSOFT_INTERFACES_SMARTTIMERMANAGERBASE_H_
+
+#include <deque>
+#include <vector>
+#include <utility>
+
+// C++11 includes
+#include <memory>
+#include <unordered_map>
+#include <chrono>
+#include <mutex>
+#include <thread>
+#include <condition_variable>
+
+#include "smartITimerManager.h"
+#include "smartTimingWheel.h"
+
+namespace Smart {
+
+/** Common base class of the reference ITimerManager implementations
+ *
+ *  This class implements the ITimerManager interface on top of a TimingWheel and provides
+ *  the dispatching of expired timers. Derived classes only provide the mechanism that
+ *  waits for the next expiry (e.g. a thread with a condition variable or an epoll loop):
+ *  they call dispatch_expired() whenever the next expiry might be due and get notified
+ *  via notify_dispatcher() if a timer is scheduled that expires earlier than expected.
+ *
+ *  Depending on the TimerDispatchMode, the ITimerHandler::timerExpired() upcalls are either
+ *  executed by the thread calling dispatch_expired() or by an internal pool of worker threads.
+ *  Upcalls are always executed outside of the internal lock, so handlers can (re)schedule and
+ *  cancel timers themselves. The ITimerHandler::timerCancelled() upcall is called from within
+ *  the thread that cancelled the timer, ITimerHandler::timerDeleted() is called after the (last)
+ *  expiry of a one-shot timer. After cancelTimer() or cancelTimersOf() returned, the handler is
+ *  not called anymore (if other threads currently execute upcalls of that handler, the cancelling
+ *  call waits for these upcalls to finish; handlers must therefore not cancel each other's timers
+ *  from within concurrently executed upcalls).
+ *
+ *  Each upcall is recorded in the lateness statistics and histograms (see record_upcall()).
+ *  The lateness of an upcall is the time between the scheduled expiry and the start of the
+ *  upcall, i.e. the sum of the fire lateness and the dispatch delay.
+ */
+class TimerManagerBase : public ITimerManager {
+private:
+	// an expired timer waiting for its upcall
+	struct DispatchJob {
+		TimingWheel::ExpiredTimer timer;
+		TimingWheel::TimePoint fired;
+	};
+
+	std::condition_variable dispatch_cond_var;
+	std::condition_variable worker_cond_var;
+	// the upcalls that are currently in progress (executing thread and handler)
+	std::vector<std::pair<std::thread::id,ITimerHandler*> > active_upcalls;
+	std::vector<TimingWheel::ExpiredTimer> expired;
+
+	TimerDispatchMode dispatch_mode;
+	std::deque<DispatchJob> dispatch_queue;
+	std::vector<std::thread> workers;
+	bool workers_stopped;
+
+	// scheduling parameters for the dispatching thread(s)
+	TaskSchedulingParameters dispatch_parameters;
+	unsigned long parameters_generation;
+
+	TimerCoalescingStatistics coalescing_statistics;
+	TimerLatenessStatistics lateness_statistics;
+	TimerLatenessHistograms lateness_histograms;
+
+	// the per-timer state used for the jitter and the optional per-timer histograms
+	struct TimerTrace {
+		bool sampled;
+		TimingWheel::Duration last_lateness;
+		std::unique_ptr<TimerLatenessHistograms> histograms;
+		TimerTrace()
+		:	sampled(false)
+		,	last_lateness(TimingWheel::Duration::zero())
+		{  }
+	};
+	// the per-timer dispatch state, preallocated for each entry of the wheel's pool (see TimingWheel::indexOf())
+	struct TimerSlot {
+		// an expiry of the timer waits in the dispatch_queue
+		bool queued;
+		TimerTrace trace;
+		TimerSlot()
+		:	queued(false)
+		{  }
+	};
+	std::vector<TimerSlot> timer_slots;
+
+	// the monitoring of the lateness percentile (see setLatenessWarning())
+	ITimerLatenessObserver *lateness_observer;
+	TimingWheel::Duration lateness_threshold;
+	double lateness_percentile;
+	unsigned int lateness_window;
+	TimerHistogram window_histogram;
+	bool lateness_exceeded;
+	TimingWheel::Duration exceeded_lateness;
+
+	inline bool isExecuting(const ITimerHandler *handler) const {
+		for(auto it=active_upcalls.begin(); it!=active_upcalls.end(); it++) {
+			if(it->second == handler) return true;
+		}
+		return false;
+	}
+
+	// returns the slot of a scheduled timer (0 for cancelled or released timers)
+	inline TimerSlot* slotOf(const TimerId &id) {
+		const std::int32_t index = wheel.indexOf(id);
+		return (index >= 0)? &timer_slots[index] : 0;
+	}
+
+	// waits until the given handler (or any handler for 0) is not executed by other threads anymore
+	inline void waitForDispatchOf(std::unique_lock<std::mutex> &lock, const ITimerHandler *handler) {
+		const std::thread::id self = std::this_thread::get_id();
+		bool executing = true;
+		while(executing) {
+			executing = false;
+			for(auto it=active_upcalls.begin(); it!=active_upcalls.end(); it++) {
+				if(it->first != self && (handler == 0 || it->second == handler)) executing = true;
+			}
+			if(executing) dispatch_cond_var.wait(lock);
+		}
+	}
+
+	int cancelTimers(std::unique_lock<std::mutex> &lock, const std::vector<TimerId> &ids, const ITimerHandler *handler) {
+		std::vector<ITimerHandler*> handlers;
+		for(auto it=ids.begin(); it!=ids.end(); it++) {
+			ITimerHandler *timer_handler = 0;
+			TimerSlot *slot = this->slotOf(*it);
+			if(wheel.cancel(*it, timer_handler)) {
+				*slot = TimerSlot();
+				handlers.push_back(timer_handler);
+			}
+		}
+		this->waitForDispatchOf(lock, handler);
+		lock.unlock();
+		for(auto it=handlers.begin(); it!=handlers.end(); it++) {
+			(*it)->timerCancelled();
+		}
+		return static_cast<int>(handlers.size());
+	}
+
+	// executes a single upcall (must be called with the lock held, the lock is released during the upcall)
+	void execute(std::unique_lock<std::mutex> &lock, const DispatchJob &job) {
+		// the timer might have been cancelled in the meantime
+		TimerSlot *slot = this->slotOf(job.timer.id);
+		if(slot == 0) return;
+		ITimerHandler *handler = job.timer.handler;
+		if(!job.timer.periodic) {
+			// the upcall of a one-shot timer is not traced (there is no jitter of a single expiry)
+			wheel.release(job.timer.id);
+			*slot = TimerSlot();
+		}
+		active_upcalls.push_back(std::make_pair(std::this_thread::get_id(), handler));
+		lock.unlock();
+		TimingWheel::TimePoint start = this->current_time();
+		handler->timerExpired(this->current_system_time());
+		if(!job.timer.periodic) handler->timerDeleted();
+		TimingWheel::TimePoint end = this->current_time();
+		lock.lock();
+		for(auto it=active_upcalls.begin(); it!=active_upcalls.end(); it++) {
+			if(it->first == std::this_thread::get_id() && it->second == handler) {
+				active_upcalls.erase(it);
+				break;
+			}
+		}
+		this->record_upcall(job.timer, job.fired - job.timer.deadline, start - job.fired, end - start);
+		dispatch_cond_var.notify_all();
+		if(lateness_exceeded) {
+			// inform the observer outside of the lock
+			lateness_exceeded = false;
+			ITimerLatenessObserver *observer = lateness_observer;
+			TimingWheel::Duration lateness = exceeded_lateness;
+			TimingWheel::Duration threshold = lateness_threshold;
+			if(observer != 0) {
+				lock.unlock();
+				observer->latenessThresholdExceeded(lateness, threshold);
+				lock.lock();
+			}
+		}
+	}
+
+	void worker_loop() {
+		unsigned long applied_generation = 0;
+		std::unique_lock<std::mutex> lock(timer_mutex);
+		while(true) {
+			this->apply_dispatch_parameters(applied_generation);
+			// select the first job whose handler is allowed to be executed right now
+			auto job = dispatch_queue.begin();
+			if(dispatch_mode == TIMER_DISPATCH_SERIAL_PER_HANDLER) {
+				while(job != dispatch_queue.end() && this->isExecuting(job->timer.handler)) job++;
+			}
+			if(job == dispatch_queue.end()) {
+				if(workers_stopped && dispatch_queue.empty()) break;
+				worker_cond_var.wait(lock);
+				continue;
+			}
+			DispatchJob current = *job;
+			dispatch_queue.erase(job);
+			TimerSlot *slot = this->slotOf(current.timer.id);
+			if(slot != 0) slot->queued = false;
+			this->execute(lock, current);
+			// a serialized handler might have become free for further jobs
+			worker_cond_var.notify_all();
+		}
+	}
+
+	void stopWorkers(std::unique_lock<std::mutex> &lock) {
+		workers_stopped = true;
+		worker_cond_var.notify_all();
+		std::vector<std::thread> stopped_workers;
+		stopped_workers.swap(workers);
+		lock.unlock();
+		for(auto it=stopped_workers.begin(); it!=stopped_workers.end(); it++) {
+			if(it->joinable()) it->join();
+		}
+		lock.lock();
+		workers_stopped = false;
+	}
+
+protected:
+	/// the mutex protecting the wheel (can be used in derived classes to protect their own state)
+	std::mutex timer_mutex;
+	/// the timer storage
+	TimingWheel wheel;
+
+	/// returns the current time of the timer manager
+	virtual TimingWheel::TimePoint current_time() const {
+		return std::chrono::steady_clock::now();
+	}
+
+	/// returns the time passed to ITimerHandler::timerExpired()
+	virtual std::chrono::system_clock::time_point current_system_time() const {
+		return std::chrono::system_clock::now();
+	}
+
+	/** Informs the dispatching mechanism that it has to wake up no later than the given time
+	 *
+	 *  This method is called with the timer_mutex locked.
+	 *
+	 *  @param deadline the new (potentially earlier) expiry time
+	 */
+	virtual void notify_dispatcher(const TimingWheel::TimePoint &deadline) = 0;
+
+	/** Records the timing of an executed upcall (called with the timer_mutex locked)
+	 *
+	 *  @param timer the expired timer
+	 *  @param fire_lateness the time between the scheduled expiry and its detection
+	 *  @param dispatch_delay the time between the detection and the start of the upcall
+	 *  @param handler_runtime the duration of the upcall
+	 */
+	virtual void record_upcall(const TimingWheel::ExpiredTimer &timer, const TimingWheel::Duration &fire_lateness, const TimingWheel::Duration &dispatch_delay, const TimingWheel::Duration &handler_runtime) {
+		lateness_statistics.count++;
+		lateness_statistics.totalFireLateness += fire_lateness;
+		if(fire_lateness > lateness_statistics.maxFireLateness) lateness_statistics.maxFireLateness = fire_lateness;
+		lateness_statistics.totalDispatchDelay += dispatch_delay;
+		if(dispatch_delay > lateness_statistics.maxDispatchDelay) lateness_statistics.maxDispatchDelay = dispatch_delay;
+		lateness_statistics.totalHandlerRuntime += handler_runtime;
+		if(handler_runtime > lateness_statistics.maxHandlerRuntime) lateness_statistics.maxHandlerRuntime = handler_runtime;
+
+		const TimingWheel::Duration lateness = fire_lateness + dispatch_delay;
+		lateness_histograms.lateness.add(lateness);
+		lateness_histograms.handlerRuntime.add(handler_runtime);
+
+		// the jitter is tracked for periodic timers (the trace of a timer is preallocated with its slot)
+		TimerLatenessHistograms *timer_histograms = 0;
+		TimerSlot *slot = this->slotOf(timer.id);
+		if(slot != 0) {
+			TimerTrace &trace = slot->trace;
+			timer_histograms = trace.histograms.get();
+			if(trace.sampled) {
+				TimingWheel::Duration jitter = lateness - trace.last_lateness;
+				if(jitter < TimingWheel::Duration::zero()) jitter = -jitter;
+				lateness_histograms.jitter.add(jitter);
+				if(timer_histograms != 0) timer_histograms->jitter.add(jitter);
+			}
+			trace.sampled = true;
+			trace.last_lateness = lateness;
+		}
+		if(timer_histograms != 0) {
+			timer_histograms->lateness.add(lateness);
+			timer_histograms->handlerRuntime.add(handler_runtime);
+		}
+
+		if(lateness_observer != 0) {
+			window_histogram.add(lateness);
+			if(window_histogram.getCount() >= lateness_window) {
+				TimingWheel::Duration percentile = window_histogram.getPercentile(lateness_percentile);
+				if(percentile > lateness_threshold) {
+					lateness_exceeded = true;
+					exceeded_lateness = percentile;
+				}
+				window_histogram.reset();
+			}
+		}
+	}
+
+	/** Applies changed dispatch-thread parameters to the calling thread
+	 *
+	 *  Must be called with the timer_mutex locked from within each dispatching thread.
+	 *
+	 *  @param applied_generation the thread-local generation of the already applied parameters
+	 */
+	inline void apply_dispatch_parameters(unsigned long &applied_generation) {
+		if(applied_generation != parameters_generation) {
+			applied_generation = parameters_generation;
+			applyThreadSchedulingParameters(dispatch_parameters);
+		}
+	}
+
+	/** Dispatches all timers that are due at current_time()
+	 *
+	 *  Must be called with the timer_mutex locked. In the TIMER_DISPATCH_INLINE mode, the lock is
+	 *  temporarily released during the upcalls, otherwise the upcalls are handed over to the workers.
+	 *
+	 *  @param lock the lock of the timer_mutex
+	 *
+	 *  @return the number of expired timers
+	 */
+	std::size_t dispatch_expired(std::unique_lock<std::mutex> &lock) {
+		expired.clear();
+		const TimingWheel::TimePoint now = this->current_time();
+		std::size_t expiry_ticks = wheel.advance(now, expired);
+		if(expired.empty()) return 0;
+
+		coalescing_statistics.wakeups++;
+		coalescing_statistics.expiries += expired.size();
+		coalescing_statistics.savedWakeups += expiry_ticks - 1;
+
+		DispatchJob job;
+		job.fired = now;
+		if(dispatch_mode == TIMER_DISPATCH_INLINE) {
+			for(auto it=expired.begin(); it!=expired.end(); it++) {
+				job.timer = *it;
+				this->execute(lock, job);
+			}
+		} else {
+			for(auto it=expired.begin(); it!=expired.end(); it++) {
+				TimerSlot &slot = timer_slots[wheel.indexOf(it->id)];
+				if(dispatch_mode == TIMER_DISPATCH_SERIAL_PER_HANDLER && slot.queued) {
+					lateness_statistics.skippedExpiries++;
+					continue;
+				}
+				slot.queued = true;
+				job.timer = *it;
+				dispatch_queue.push_back(job);
+			}
+			worker_cond_var.notify_all();
+		}
+		return expired.size();
+	}
+
+public:
+	/** Default constructor
+	 *
+	 *  @param resolution the tick resolution of the internal TimingWheel
+	 *  @param origin the start time of the internal TimingWheel
+	 */
+	TimerManagerBase(const std::chrono::steady_clock::duration &resolution=std::chrono::milliseconds(1), const TimingWheel::TimePoint &origin=std::chrono::steady_clock::now())
+	:	dispatch_mode(TIMER_DISPATCH_INLINE)
+	,	workers_stopped(false)
+	,	parameters_generation(0)
+	,	lateness_observer(0)
+	,	lateness_threshold(TimingWheel::Duration::max())
+	,	lateness_percentile(0.99)
+	,	lateness_window(1000)
+	,	lateness_exceeded(false)
+	,	exceeded_lateness(TimingWheel::Duration::zero())
+	,	wheel(resolution, origin)
+	{  }
+
+	/** Default destructor
+	 *
+	 *  Derived classes have to stop their dispatching mechanism before. The workers are
+	 *  stopped (after finishing the queued upcalls) and the remaining timers are cancelled here.
+	 */
+	virtual ~TimerManagerBase()
+	{
+		std::unique_lock<std::mutex> lock(timer_mutex);
+		this->stopWorkers(lock);
+		std::vector<TimerId> ids;
+		wheel.findAllTimers(ids);
+		this->cancelTimers(lock, ids, 0);
+	}
+
+	virtual TimerId scheduleTimer(
+			ITimerHandler *handler,
+			const std::chrono::steady_clock::duration &first_time,
+			const std::chrono::steady_clock::duration &interval=std::chrono::steady_clock::duration::zero()
+		)
+	{
+		return this->scheduleTimerWithSlack(handler, first_time, interval, std::chrono::steady_clock::duration::zero());
+	}
+
+	virtual TimerId scheduleTimerWithSlack(
+			ITimerHandler *handler,
+			const std::chrono::steady_clock::duration &first_time,
+			const std::chrono::steady_clock::duration &interval,
+			const std::chrono::steady_clock::duration &slack
+		)
+	{
+		if(handler == 0) return -1;
+		std::unique_lock<std::mutex> lock(timer_mutex);
+		TimingWheel::TimePoint deadline = this->current_time() + first_time;
+		TimerId id = wheel.schedule(handler, deadline, interval, slack);
+		if(id < 0) return -1;
+		// the slots grow with the wheel's pool, so the dispatch path never allocates per-timer state
+		if(timer_slots.size() < wheel.capacity()) timer_slots.resize(wheel.capacity());
+		// the dispatcher needs to wake up no later than when the new timer's slack runs out
+		this->notify_dispatcher(deadline + slack);
+		return id;
+	}
+
+	virtual int cancelTimer(const TimerId& id) {
+		std::unique_lock<std::mutex> lock(timer_mutex);
+		ITimerHandler *handler = wheel.getHandler(id);
+		if(handler == 0) return -1;
+		std::vector<TimerId> ids(1, id);
+		this->cancelTimers(lock, ids, handler);
+		return 0;
+	}
+
+	virtual int resetTimerInterval(
+			const TimerId& id,
+			const std::chrono::steady_clock::duration &interval
+		)
+	{
+		std::unique_lock<std::mutex> lock(timer_mutex);
+		return wheel.resetInterval(id, interval)? 0 : -1;
+	}
+
+	/** Cancels all timers of the given handler
+	 *
+	 *  The timers of each handler are indexed, so the costs only depend on the number
+	 *  of timers of this handler and not on the total number of timers. Waits for upcalls
+	 *  of this handler that are executed by other threads, so a handler can call this
+	 *  method from within its destructor (see ITimerHandler).
+	 *
+	 *  @return the number of cancelled timers
+	 */
+	virtual int cancelTimersOf(ITimerHandler *handler) {
+		std::unique_lock<std::mutex> lock(timer_mutex);
+		std::vector<TimerId> ids;
+		wheel.findTimersOf(handler, ids);
+		return this->cancelTimers(lock, ids, handler);
+	}
+
+	virtual void cancelAllTimers() {
+		std::unique_lock<std::mutex> lock(timer_mutex);
+		std::vector<TimerId> ids;
+		wheel.findAllTimers(ids);
+		this->cancelTimers(lock, ids, 0);
+	}
+
+	/** Sets the scheduling parameters of the dispatching thread(s)
+	 *
+	 *  The parameters are applied by each dispatching thread (and each worker) itself before it
+	 *  processes the next expiries. The stack size can not be changed for already running threads.
+	 */
+	virtual int setDispatchThreadParameters(const TaskSchedulingParameters &params) {
+		std::unique_lock<std::mutex> lock(timer_mutex);
+		dispatch_parameters = params;
+		parameters_generation++;
+		worker_cond_var.notify_all();
+		this->notify_dispatcher(TimingWheel::TimePoint::min());
+		return 0;
+	}
+
+	virtual TimerCoalescingStatistics getCoalescingStatistics() {
+		std::unique_lock<std::mutex> lock(timer_mutex);
+		return coalescing_statistics;
+	}
+
+	/** Selects how the timer upcalls are executed
+	 *
+	 *  Switching to TIMER_DISPATCH_INLINE (or changing the number of workers) stops the
+	 *  current workers after they finished the already queued upcalls. Must not be called
+	 *  from within an upcall.
+	 */
+	virtual int setDispatchMode(const TimerDispatchMode &mode, const unsigned int &workers=2) {
+		std::unique_lock<std::mutex> lock(timer_mutex);
+		if(mode != TIMER_DISPATCH_INLINE && workers == 0) return -1;
+		if(mode == TIMER_DISPATCH_INLINE || this->workers.size() != workers) {
+			this->stopWorkers(lock);
+		}
+		dispatch_mode = mode;
+		if(mode != TIMER_DISPATCH_INLINE) {
+			while(this->workers.size() < workers) {
+				this->workers.push_back(std::thread(&TimerManagerBase::worker_loop, this));
+			}
+		}
+		return 0;
+	}
+
+	virtual TimerLatenessStatistics getLatenessStatistics() {
+		std::unique_lock<std::mutex> lock(timer_mutex);
+		return lateness_statistics;
+	}
+
+	virtual TimerLatenessHistograms getLatenessHistograms() {
+		std::unique_lock<std::mutex> lock(timer_mutex);
+		return lateness_histograms;
+	}
+
+	virtual void resetLatenessStatistics() {
+		std::unique_lock<std::mutex> lock(timer_mutex);
+		lateness_statistics = TimerLatenessStatistics();
+		lateness_histograms = TimerLatenessHistograms();
+		window_histogram.reset();
+		for(auto it=timer_slots.begin(); it!=timer_slots.end(); it++) {
+			if(it->trace.histograms) *(it->trace.histograms) = TimerLatenessHistograms();
+		}
+	}
+
+	virtual int setTimerStatisticsEnabled(const TimerId &id, const bool &enable) {
+		std::unique_lock<std::mutex> lock(timer_mutex);
+		TimerSlot *slot = this->slotOf(id);
+		if(slot == 0) return -1;
+		if(enable) {
+			if(!slot->trace.histograms) slot->trace.histograms.reset(new TimerLatenessHistograms());
+		} else {
+			slot->trace.histograms.reset();
+		}
+		return 0;
+	}
+
+	virtual int getTimerLatenessHistograms(const TimerId &id, TimerLatenessHistograms &histograms) {
+		std::unique_lock<std::mutex> lock(timer_mutex);
+		TimerSlot *slot = this->slotOf(id);
+		if(slot == 0 || !slot->trace.histograms) return -1;
+		histograms = *(slot->trace.histograms);
+		return 0;
+	}
+
+	virtual int setLatenessWarning(
+			ITimerLatenessObserver *observer,
+			const std::chrono::steady_clock::duration &threshold,
+			const double &percentile=0.99,
+			const unsigned int &window=1000
+		)
+	{
+		std::unique_lock<std::mutex> lock(timer_mutex);
+		if(window == 0 || percentile < 0.0 || percentile > 1.0) return -1;
+		lateness_observer = observer;
+		lateness_threshold = threshold;
+		lateness_percentile = percentile;
+		lateness_window = window;
+		lateness_exceeded = false;
+		window_histogram.reset();
+		return 0;
+	}
+};
+
+} /* namespace Smart */
+
+#endif /* SMARTSOFT_INTERFACES_SMARTTIMERMANAGERBASE_H_ */
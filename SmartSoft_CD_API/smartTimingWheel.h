@@ -0,0 +1,596 @@
+//===================================================================================
+//
+//  Copyright (C) 2017 Alex Lotz, Dennis Stampfer, Matthias Lutz, Christian Schlegel
+//
+//        lotz@hs-ulm.de
+//        stampfer@hs-ulm.de
+//        lutz@hs-ulm.de
+//        schlegel@hs-ulm.de
+//
+//        Servicerobotik Ulm
+//        Christian Schlegel
+//        Ulm University of Applied Sciences
+//        Prittwitzstr. 10
+//        89075 Ulm
+//        Germany
+//
+//  This file is part of the SmartSoft Component-Developer C++ API.
+//
+//  Redistribution and use in source and binary forms, with or without modification,
+//  are permitted provided that the following conditions are met:
+//
+//  1. Redistributions of source code must retain the above copyright notice,
+//     this list of conditions and the following disclaimer.
+//
+//  2. Redistributions in binary form must reproduce the above copyright notice,
+//     this list of conditions and the following disclaimer in the documentation
+//     and/or other materials provided with the distribution.
+//
+//  3. Neither the name of the copyright holder nor the names of its contributors
+//     may be used to endorse or promote products derived from this software
+//     without specific prior written permission.
+//
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+//  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+//  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+//  IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+//  INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+//  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+//  DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+//  LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE
+//  OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+//  OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+//===================================================================================
+
+#ifndef SMARTSOFT_INTERFACES_SMARTTIMINGWHEEL_H_
+#define SMARTSOFT_INTERFACES_SMARTTIMINGWHEEL_H_
+
+#include <vector>
+#include <algorithm>
+#include <unordered_map>
+#include <cstdint>
+#include <cstddef>
+
+// C++11 chrono
+#include <chrono>
+
+#include "smartITimerHandler.h"
+
+namespace Smart {
+
+/** Hierarchical timing wheel (not thread-safe)
+ *
+ *  This class implements the timer storage used by the reference ITimerManager
+ *  implementations. Timers are quantized to ticks of a configurable resolution
+ *  (a timer never expires before its deadline) and are kept in five levels of buckets
+ *  (256 buckets for the next 256 ticks, and 4 levels with 64 buckets each, covering
+ *  2^32 ticks in total). Each bucket is an intrusive doubly-linked list of entries that
+ *  are allocated from an internal pool, which results in O(1) schedule(), cancel()
+ *  and resetInterval(). Timers of a higher level are cascaded into the next-lower level
+ *  once their bucket becomes due (see "Hashed and Hierarchical Timing Wheels",
+ *  Varghese and Lauck).
+ *
+ *  A TimerId encodes the pool index and a generation counter, so stale ids of already
+ *  released timers are detected without any lookup structure. Additionally, all timers
+ *  of a handler are chained in an intrusive per-handler list, so findTimersOf() costs
+ *  O(k) in the number of timers of that handler.
+ *
+ *  Each timer can have a slack, i.e. a tolerance by which its expiry may be delayed.
+ *  nextExpiry() returns the earliest time at which a timer's slack runs out, so that
+ *  all timers whose deadlines fall into that window are expired by a single advance().
+ */
+class TimingWheel {
+public:
+	/// same as ITimerManager::TimerId
+	typedef long TimerId;
+	typedef std::chrono::steady_clock::time_point TimePoint;
+	typedef std::chrono::steady_clock::duration Duration;
+
+	/// an entry returned by advance() for each expired timer
+	struct ExpiredTimer {
+		/// the id of the expired timer
+		TimerId id;
+		/// the handler of the expired timer
+		ITimerHandler *handler;
+		/// the scheduled (not the actual) expiry time
+		TimePoint deadline;
+		/// true for periodic timers (which are already rescheduled)
+		bool periodic;
+	};
+
+private:
+	enum {
+		ROOT_BITS = 8,
+		LEVEL_BITS = 6,
+		HIGHER_LEVELS = 4,
+		ROOT_SIZE = 1 << ROOT_BITS,
+		LEVEL_SIZE = 1 << LEVEL_BITS,
+		NUM_BUCKETS = ROOT_SIZE + HIGHER_LEVELS*LEVEL_SIZE,
+		// the maximum number of timers that nextExpiry() inspects within a single bucket
+		MAX_BUCKET_SCAN = 32,
+		// the lower bits of a TimerId store the pool index, the upper bits the generation
+		INDEX_BITS = 24,
+		// a fired one-shot timer waits for release()
+		BUCKET_FIRED = -1,
+		// the entry is not in use
+		BUCKET_FREE = -2
+	};
+
+	struct Entry {
+		ITimerHandler *handler;
+		TimePoint deadline;
+		Duration interval;
+		Duration slack;
+		std::uint64_t expires;
+		// the tick of deadline + slack
+		std::uint64_t latest;
+		unsigned long generation;
+		std::int32_t prev;
+		std::int32_t next;
+		std::int32_t bucket;
+		// the intrusive per-handler list
+		std::int32_t handler_prev;
+		std::int32_t handler_next;
+	};
+
+	std::vector<Entry> entries;
+	std::int32_t free_head;
+	std::int32_t bucket_head[NUM_BUCKETS];
+	std::int32_t bucket_tail[NUM_BUCKETS];
+	// the first timer of each handler that has timers
+	std::unordered_map<const ITimerHandler*, std::int32_t> handler_timers;
+
+	TimePoint origin;
+	Duration resolution;
+	// the next tick to be processed by advance()
+	std::uint64_t current_tick;
+	// number of timers that are currently stored in buckets
+	std::size_t pending_count;
+	// number of allocated entries (including fired one-shot timers that are not yet released)
+	std::size_t allocated_count;
+
+	inline std::uint64_t toTick(const TimePoint &tp) const {
+		if(tp <= origin) return 0;
+		// round up so that a timer never expires before its deadline
+		return ((tp - origin).count() + resolution.count() - 1) / resolution.count();
+	}
+
+	inline std::int32_t bucketOf(std::uint64_t expires) const {
+		if(expires < current_tick) expires = current_tick;
+		std::uint64_t delta = expires - current_tick;
+		if(delta < ROOT_SIZE) {
+			return static_cast<std::int32_t>(expires & (ROOT_SIZE-1));
+		}
+		if(delta > 0xFFFFFFFFull) {
+			// timers beyond the wheel's range are parked in the top level and re-cascaded later
+			expires = current_tick + 0xFFFFFFFFull;
+			delta = 0xFFFFFFFFull;
+		}
+		for(unsigned int level=1; level<=HIGHER_LEVELS; ++level) {
+			unsigned int shift = ROOT_BITS + level*LEVEL_BITS;
+			if(level == HIGHER_LEVELS || delta < (std::uint64_t(1) << shift)) {
+				unsigned int bucket_shift = shift - LEVEL_BITS;
+				return ROOT_SIZE + (level-1)*LEVEL_SIZE + static_cast<std::int32_t>((expires >> bucket_shift) & (LEVEL_SIZE-1));
+			}
+		}
+		return -1; // not reachable
+	}
+
+	inline void link(const std::int32_t &index) {
+		Entry &e = entries[index];
+		e.bucket = bucketOf(e.expires);
+		e.next = -1;
+		e.prev = bucket_tail[e.bucket];
+		if(e.prev >= 0) entries[e.prev].next = index;
+		else bucket_head[e.bucket] = index;
+		bucket_tail[e.bucket] = index;
+		pending_count++;
+	}
+
+	inline void unlink(const std::int32_t &index) {
+		Entry &e = entries[index];
+		if(e.prev >= 0) entries[e.prev].next = e.next;
+		else bucket_head[e.bucket] = e.next;
+		if(e.next >= 0) entries[e.next].prev = e.prev;
+		else bucket_tail[e.bucket] = e.prev;
+		e.prev = e.next = -1;
+		e.bucket = BUCKET_FIRED;
+		pending_count--;
+	}
+
+	inline std::int32_t allocate() {
+		if(free_head < 0) {
+			if(entries.size() >= (std::size_t(1) << INDEX_BITS)) return -1;
+			Entry e;
+			e.generation = 0;
+			e.bucket = BUCKET_FREE;
+			e.prev = e.next = -1;
+			e.handler_prev = e.handler_next = -1;
+			entries.push_back(e);
+			free_head = static_cast<std::int32_t>(entries.size()-1);
+		}
+		std::int32_t index = free_head;
+		free_head = entries[index].next;
+		allocated_count++;
+		return index;
+	}
+
+	inline void linkHandler(const std::int32_t &index) {
+		Entry &e = entries[index];
+		auto it = handler_timers.find(e.handler);
+		e.handler_prev = -1;
+		if(it == handler_timers.end()) {
+			e.handler_next = -1;
+			handler_timers[e.handler] = index;
+		} else {
+			e.handler_next = it->second;
+			entries[it->second].handler_prev = index;
+			it->second = index;
+		}
+	}
+
+	inline void unlinkHandler(const std::int32_t &index) {
+		Entry &e = entries[index];
+		if(e.handler_prev >= 0) {
+			entries[e.handler_prev].handler_next = e.handler_next;
+		} else if(e.handler_next >= 0) {
+			handler_timers[e.handler] = e.handler_next;
+		} else {
+			handler_timers.erase(e.handler);
+		}
+		if(e.handler_next >= 0) entries[e.handler_next].handler_prev = e.handler_prev;
+		e.handler_prev = e.handler_next = -1;
+	}
+
+	inline void deallocate(const std::int32_t &index) {
+		Entry &e = entries[index];
+		this->unlinkHandler(index);
+		e.bucket = BUCKET_FREE;
+		e.handler = 0;
+		// invalidate all ids that refer to this entry (generation 0 is never used)
+		e.generation = (e.generation + 1) & maxGeneration();
+		if(e.generation == 0) e.generation = 1;
+		e.prev = -1;
+		e.next = free_head;
+		free_head = index;
+		allocated_count--;
+	}
+
+	static inline unsigned long maxGeneration() {
+		return static_cast<unsigned long>(-1L) >> (INDEX_BITS + 1);
+	}
+
+	inline TimerId makeId(const std::int32_t &index) const {
+		return static_cast<TimerId>((entries[index].generation << INDEX_BITS) | static_cast<unsigned long>(index));
+	}
+
+	inline std::int32_t findIndex(const TimerId &id) const {
+		if(id <= 0) return -1;
+		std::int32_t index = static_cast<std::int32_t>(id & ((1L << INDEX_BITS)-1));
+		if(index >= static_cast<std::int32_t>(entries.size())) return -1;
+		const Entry &e = entries[index];
+		if(e.bucket == BUCKET_FREE || e.generation != (static_cast<unsigned long>(id) >> INDEX_BITS)) return -1;
+		return index;
+	}
+
+	// returns the earliest expiry tick of all pending timers (the costs are linear in the pool size)
+	inline std::uint64_t earliestTick() const {
+		std::uint64_t earliest = ~std::uint64_t(0);
+		for(std::size_t i=0; i<entries.size(); ++i) {
+			if(entries[i].bucket >= 0 && entries[i].expires < earliest) earliest = entries[i].expires;
+		}
+		return earliest;
+	}
+
+	// moves the wheel directly to the given tick and places all pending timers relative to that tick
+	inline void jumpTo(const std::uint64_t &tick) {
+		current_tick = tick;
+		for(std::size_t i=0; i<entries.size(); ++i) {
+			if(entries[i].bucket < 0) continue;
+			const std::int32_t index = static_cast<std::int32_t>(i);
+			this->unlink(index);
+			this->link(index);
+		}
+	}
+
+	// moves all timers of the given higher-level bucket into the lower levels
+	inline void cascade(const std::int32_t &bucket) {
+		std::int32_t index = bucket_head[bucket];
+		bucket_head[bucket] = bucket_tail[bucket] = -1;
+		while(index >= 0) {
+			std::int32_t next = entries[index].next;
+			pending_count--;
+			this->link(index);
+			index = next;
+		}
+	}
+
+	// lowers best to the earliest slack end within the bucket (or to the bucket's start tick if the bucket is too large)
+	inline void scanBucket(const std::int32_t &bucket, const std::uint64_t &start_tick, std::uint64_t &best) const {
+		unsigned int scanned = 0;
+		std::int32_t index = bucket_head[bucket];
+		for(; index >= 0 && scanned < MAX_BUCKET_SCAN; index = entries[index].next, ++scanned) {
+			if(entries[index].latest < best) best = entries[index].latest;
+		}
+		if(index >= 0 && start_tick < best) best = start_tick;
+	}
+
+	inline std::int32_t levelBucket(const unsigned int &level, const std::uint64_t &tick) const {
+		unsigned int bucket_shift = ROOT_BITS + (level-1)*LEVEL_BITS;
+		return ROOT_SIZE + (level-1)*LEVEL_SIZE + static_cast<std::int32_t>((tick >> bucket_shift) & (LEVEL_SIZE-1));
+	}
+
+public:
+	/** Default constructor
+	 *
+	 *  @param resolution the duration of a single tick (timers are rounded up to full ticks)
+	 *  @param origin the time of tick zero
+	 */
+	TimingWheel(const Duration &resolution=std::chrono::milliseconds(1), const TimePoint &origin=std::chrono::steady_clock::now())
+	:	free_head(-1)
+	,	origin(origin)
+	,	resolution((resolution > Duration::zero())? resolution : Duration(1))
+	,	current_tick(0)
+	,	pending_count(0)
+	,	allocated_count(0)
+	{
+		for(int i=0; i<NUM_BUCKETS; ++i) {
+			bucket_head[i] = bucket_tail[i] = -1;
+		}
+	}
+
+	/// returns the tick resolution
+	inline Duration getResolution() const {
+		return resolution;
+	}
+
+	/// returns the start of the tick at which a timer with the given deadline is expired by advance()
+	inline TimePoint tickTime(const TimePoint &deadline) const {
+		return origin + resolution * static_cast<Duration::rep>(toTick(deadline));
+	}
+
+	/// returns the number of entries in the timer pool (allocated and free ones)
+	inline std::size_t capacity() const {
+		return entries.size();
+	}
+
+	/** Returns the pool index of a timer
+	 *
+	 *  The index of a timer does not change until it is cancelled or released and is always
+	 *  below capacity(), so users can keep additional per-timer state in a parallel array.
+	 *
+	 *  @return the index or -1 for an unknown id
+	 */
+	inline std::int32_t indexOf(const TimerId &id) const {
+		return this->findIndex(id);
+	}
+
+	/// returns the number of allocated timers (including fired one-shot timers that are not yet released)
+	inline std::size_t size() const {
+		return allocated_count;
+	}
+
+	/** Schedules a new timer
+	 *
+	 *  @param handler the handler to be returned by advance() on expiry
+	 *  @param deadline the (first) expiry time
+	 *  @param interval the re-arming interval (zero for one-shot timers)
+	 *  @param slack the tolerance by which each expiry may be delayed in favor of coalescing
+	 *
+	 *  @return the new timer id or -1 if the pool is exhausted
+	 */
+	TimerId schedule(ITimerHandler *handler, const TimePoint &deadline, const Duration &interval=Duration::zero(), const Duration &slack=Duration::zero()) {
+		std::int32_t index = this->allocate();
+		if(index < 0) return -1;
+		Entry &e = entries[index];
+		if(e.generation == 0) e.generation = 1;
+		e.handler = handler;
+		e.deadline = deadline;
+		e.interval = interval;
+		e.slack = (slack > Duration::zero())? slack : Duration::zero();
+		e.expires = toTick(deadline);
+		e.latest = toTick(deadline + e.slack);
+		this->link(index);
+		this->linkHandler(index);
+		return makeId(index);
+	}
+
+	/** Cancels a pending timer (or releases a fired one-shot timer)
+	 *
+	 *  @param id the timer id
+	 *  @param handler is set to the handler of the cancelled timer
+	 *
+	 *  @return true if the timer has been cancelled or false for an unknown id
+	 */
+	bool cancel(const TimerId &id, ITimerHandler *&handler) {
+		std::int32_t index = findIndex(id);
+		if(index < 0) return false;
+		handler = entries[index].handler;
+		if(entries[index].bucket >= 0) this->unlink(index);
+		this->deallocate(index);
+		return true;
+	}
+
+	/** Releases a fired one-shot timer (see ExpiredTimer::periodic)
+	 *
+	 *  @param id the timer id
+	 *
+	 *  @return true if the timer has been released
+	 */
+	inline bool release(const TimerId &id) {
+		ITimerHandler *handler = 0;
+		return this->cancel(id, handler);
+	}
+
+	/// returns true if the id refers to a pending timer or to a not yet released one-shot timer
+	inline bool contains(const TimerId &id) const {
+		return findIndex(id) >= 0;
+	}
+
+	/// returns the handler of the given timer or 0 for unknown ids
+	inline ITimerHandler* getHandler(const TimerId &id) const {
+		std::int32_t index = findIndex(id);
+		return (index >= 0)? entries[index].handler : 0;
+	}
+
+	/** Changes the re-arming interval of a timer
+	 *
+	 *  The currently scheduled expiry remains unchanged, the new interval
+	 *  is used for all subsequent expiries. A zero interval turns a
+	 *  periodic timer into a one-shot timer.
+	 *
+	 *  @return true on success or false for an unknown id
+	 */
+	bool resetInterval(const TimerId &id, const Duration &interval) {
+		std::int32_t index = findIndex(id);
+		if(index < 0) return false;
+		entries[index].interval = interval;
+		return true;
+	}
+
+	/** Collects the ids of all allocated timers of a handler (in O(k) using the per-handler list)
+	 *
+	 *  @param handler the handler to look for
+	 *  @param ids the ids are appended to this vector
+	 */
+	void findTimersOf(const ITimerHandler *handler, std::vector<TimerId> &ids) const {
+		auto it = handler_timers.find(handler);
+		if(it == handler_timers.end()) return;
+		for(std::int32_t index = it->second; index >= 0; index = entries[index].handler_next) {
+			ids.push_back(makeId(index));
+		}
+	}
+
+	/// returns true if the handler has at least one allocated timer
+	inline bool hasTimersOf(const ITimerHandler *handler) const {
+		return handler_timers.find(handler) != handler_timers.end();
+	}
+
+	/// collects the ids of all allocated timers
+	void findAllTimers(std::vector<TimerId> &ids) const {
+		for(std::size_t i=0; i<entries.size(); ++i) {
+			if(entries[i].bucket != BUCKET_FREE) {
+				ids.push_back(makeId(static_cast<std::int32_t>(i)));
+			}
+		}
+	}
+
+	/** Advances the wheel up to the given time and collects all expired timers
+	 *
+	 *  Periodic timers are rescheduled immediately (missed periods are skipped),
+	 *  fired one-shot timers remain allocated until release() is called, which
+	 *  allows to detect timers that are cancelled before the expiry is dispatched.
+	 *
+	 *  @param now the current time
+	 *  @param expired all expired timers are appended to this vector (in order of their expiry)
+	 *
+	 *  Ticks without expiries are skipped: if the remaining distance to the given time is larger
+	 *  than the pool, the wheel jumps directly to the earliest pending expiry (re-placing all pending
+	 *  timers), so large time jumps (e.g. of a virtual clock) cost at most linear in the number of timers.
+	 *
+	 *  @return the number of distinct ticks at which timers expired (i.e. the number of wakeups
+	 *          that would have been required without coalescing)
+	 */
+	std::size_t advance(const TimePoint &now, std::vector<ExpiredTimer> &expired) {
+		if(now < origin) return 0;
+		const std::uint64_t target = (now - origin).count() / resolution.count();
+		// a jump costs about as much as stepping through this number of ticks
+		const std::uint64_t jump_distance = entries.size() + NUM_BUCKETS;
+		std::uint64_t next_jump_check = current_tick;
+		std::size_t expiry_ticks = 0;
+		while(current_tick <= target) {
+			if(pending_count == 0) {
+				current_tick = target + 1;
+				break;
+			}
+			if(current_tick >= next_jump_check && target - current_tick > jump_distance) {
+				const std::uint64_t earliest = this->earliestTick();
+				if(earliest > current_tick + 1) {
+					this->jumpTo(std::min(earliest, target + 1));
+					if(current_tick > target) break;
+				}
+				// checking again only after stepping through as many ticks keeps the checks amortized
+				next_jump_check = current_tick + jump_distance;
+			}
+			const std::int32_t root = static_cast<std::int32_t>(current_tick & (ROOT_SIZE-1));
+			if(root == 0) {
+				// cascade the higher levels (a level is only cascaded if all lower levels wrapped)
+				for(unsigned int level=1; level<=HIGHER_LEVELS; ++level) {
+					std::int32_t bucket = levelBucket(level, current_tick);
+					this->cascade(bucket);
+					if(bucket != ROOT_SIZE + static_cast<std::int32_t>((level-1)*LEVEL_SIZE)) break;
+				}
+			}
+			std::int32_t index = bucket_head[root];
+			bucket_head[root] = bucket_tail[root] = -1;
+			if(index >= 0) expiry_ticks++;
+			while(index >= 0) {
+				Entry &e = entries[index];
+				std::int32_t next = e.next;
+				e.prev = e.next = -1;
+				e.bucket = BUCKET_FIRED;
+				pending_count--;
+
+				ExpiredTimer timer;
+				timer.id = makeId(index);
+				timer.handler = e.handler;
+				timer.deadline = e.deadline;
+				timer.periodic = (e.interval > Duration::zero());
+				expired.push_back(timer);
+
+				if(timer.periodic) {
+					e.deadline += e.interval;
+					if(e.deadline <= now) {
+						// skip all missed periods
+						e.deadline += e.interval * ((now - e.deadline) / e.interval + 1);
+					}
+					e.expires = toTick(e.deadline);
+					if(e.expires <= current_tick) e.expires = current_tick + 1;
+					e.latest = toTick(e.deadline + e.slack);
+					if(e.latest < e.expires) e.latest = e.expires;
+					this->link(index);
+				}
+				index = next;
+			}
+			current_tick++;
+		}
+		return expiry_ticks;
+	}
+
+	/** Returns the next (coalesced) expiry time
+	 *
+	 *  The returned time is the earliest time at which the slack of a pending timer runs out
+	 *  (for timers without slack this is their deadline). All timers whose deadlines are due at
+	 *  that time are expired together by the next advance(). The result is exact (up to the tick
+	 *  resolution) unless a bucket contains many timers, in which case the (earlier) start time of
+	 *  that bucket is returned. The costs are bounded by the number of buckets.
+	 *
+	 *  @param next is set to the next expiry time
+	 *
+	 *  @return true if there is a pending timer or false otherwise
+	 */
+	bool nextExpiry(TimePoint &next) const {
+		if(pending_count == 0) return false;
+		std::uint64_t best = ~std::uint64_t(0);
+		for(std::uint64_t k=0; k<ROOT_SIZE && current_tick + k <= best; ++k) {
+			this->scanBucket(static_cast<std::int32_t>((current_tick + k) & (ROOT_SIZE-1)), current_tick + k, best);
+		}
+		for(unsigned int level=1; level<=HIGHER_LEVELS; ++level) {
+			unsigned int bucket_shift = ROOT_BITS + (level-1)*LEVEL_BITS;
+			// the bucket that is cascaded next (the current bucket has been cascaded already unless we are exactly at its start)
+			std::uint64_t first = (current_tick >> bucket_shift) + (((current_tick & ((std::uint64_t(1) << bucket_shift)-1)) != 0)? 1 : 0);
+			for(std::uint64_t k=0; k<LEVEL_SIZE && ((first + k) << bucket_shift) <= best; ++k) {
+				std::int32_t bucket = ROOT_SIZE + (level-1)*LEVEL_SIZE + static_cast<std::int32_t>((first + k) & (LEVEL_SIZE-1));
+				this->scanBucket(bucket, (first + k) << bucket_shift, best);
+			}
+		}
+		if(best < current_tick) best = current_tick;
+		next = origin + resolution * static_cast<Duration::rep>(best);
+		return true;
+	}
+};
+
+} /* namespace Smart */
+
+#endif /* SMARTSOFT_INTERFACES_SMARTTIMINGWHEEL_H_ */
@@ -0,0 +1,129 @@
+//===================================================================================
+//
+//  Copyright (C) 2017 Alex Lotz, Dennis Stampfer, Matthias Lutz, Christian Schlegel
+//
+//        lotz@hs-ulm.de
+//        stampfer@hs-ulm.de
+//        lutz@hs-ulm.de
+//        schlegel@hs-ulm.de
+//
+//        Servicerobotik Ulm
+//        Christian Schlegel
+//        Ulm University of Applied Sciences
+//        Prittwitzstr. 10
+//        89075 Ulm
+//        Germany
+//
+//  This file is part of the SmartSoft Component-Developer C++ API.
+//
+//  Redistribution and use in source and binary forms, with or without modification,
+//  are permitted provided that the following conditions are met:
+//
+//  1. Redistributions of source code must retain the above copyright notice,
+//     this list of conditions and the following disclaimer.
+//
+//  2. Redistributions in binary form must reproduce the above copyright notice,
+//     this list of conditions and the following disclaimer in the documentation
+//     and/or other materials provided with the distribution.
+//
+//  3. Neither the name of the copyright holder nor the names of its contributors
+//     may be used to endorse or promote products derived from this software
+//     without specific prior written permission.
+//
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+//  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+//  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+//  IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+//  INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+//  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+//  DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+//  LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE
+//  OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+//  OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+//===================================================================================
+
+#ifndef SMARTSOFT_INTERFACES_SMARTTIMINGWHEELTIMERMANAGER_H_
+#define SMARTSOFT_INTERFACES_SMARTTIMINGWHEELTIMERMANAGER_H_
+
+// C++11 includes
+#include <chrono>
+#include <mutex>
+#include <thread>
+#include <condition_variable>
+
+#include "smartTimerManagerBase.h"
+
+namespace Smart {
+
+/** Reference implementation of the ITimerManager interface based on a hierarchical timing wheel
+ *
+ *  Timers are stored in a TimingWheel, which results in O(1) scheduleTimer(), cancelTimer()
+ *  and resetTimerInterval() independent of the number of active timers. An internal dispatch
+ *  thread sleeps until the next expiry and is only woken up by scheduleTimer() if the
+ *  new timer expires before that time. See TimerManagerBase for the upcall semantics.
+ */
+class TimingWheelTimerManager : public TimerManagerBase {
+private:
+	std::condition_variable wheel_cond_var;
+	bool stopped;
+	// the time until which the dispatch thread currently sleeps (min() while it is awake)
+	TimingWheel::TimePoint wakeup_time;
+	std::thread dispatch_thread;
+
+	void dispatch_loop() {
+		unsigned long applied_generation = 0;
+		std::unique_lock<std::mutex> lock(timer_mutex);
+		while(!stopped) {
+			this->apply_dispatch_parameters(applied_generation);
+			if(this->dispatch_expired(lock) > 0) continue;
+
+			if(!wheel.nextExpiry(wakeup_time)) {
+				wakeup_time = TimingWheel::TimePoint::max();
+				wheel_cond_var.wait(lock);
+			} else {
+				wheel_cond_var.wait_until(lock, wakeup_time);
+			}
+			wakeup_time = TimingWheel::TimePoint::min();
+		}
+	}
+
+protected:
+	virtual void notify_dispatcher(const TimingWheel::TimePoint &deadline) {
+		// wake up the dispatch thread only if it sleeps beyond the given deadline
+		if(deadline < wakeup_time) {
+			wheel_cond_var.notify_one();
+		}
+	}
+
+public:
+	/** Default constructor (starts the internal dispatch thread)
+	 *
+	 *  @param resolution the tick resolution of the internal TimingWheel
+	 */
+	TimingWheelTimerManager(const std::chrono::steady_clock::duration &resolution=std::chrono::milliseconds(1))
+	:	TimerManagerBase(resolution)
+	,	stopped(false)
+	,	wakeup_time(TimingWheel::TimePoint::min())
+	{
+		dispatch_thread = std::thread(&TimingWheelTimerManager::dispatch_loop, this);
+	}
+
+	/** Default destructor
+	 *
+	 *  Stops the dispatch thread (the remaining timers are cancelled in TimerManagerBase).
+	 */
+	virtual ~TimingWheelTimerManager()
+	{
+		{
+			std::unique_lock<std::mutex> lock(timer_mutex);
+			stopped = true;
+			wheel_cond_var.notify_all();
+		}
+		if(dispatch_thread.joinable()) dispatch_thread.join();
+	}
+};
+
+} /* namespace Smart */
+
+#endif /* SMARTSOFT_INTERFACES_SMARTTIMINGWHEELTIMERMANAGER_H_ */
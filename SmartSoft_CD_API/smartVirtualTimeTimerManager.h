@@ -0,0 +1,244 @@
+//===================================================================================
+//
+//  Copyright (C) 2017 Alex Lotz, Dennis Stampfer, Matthias Lutz, Christian Schlegel
+//
+//        lotz@hs-ulm.de
+//        stampfer@hs-ulm.de
+//        lutz@hs-ulm.de
+//        schlegel@hs-ulm.de
+//
+//        Servicerobotik Ulm
+//        Christian Schlegel
+//        Ulm University of Applied Sciences
+//        Prittwitzstr. 10
+//        89075 Ulm
+//        Germany
+//
+//  This file is part of the SmartSoft Component-Developer C++ API.
+//
+//  Redistribution and use in source and binary forms, with or without modification,
+//  are permitted provided that the following conditions are met:
+//
+//  1. Redistributions of source code must retain the above copyright notice,
+//     this list of conditions and the following disclaimer.
+//
+//  2. Redistributions in binary form must reproduce the above copyright notice,
+//     this list of conditions and the following disclaimer in the documentation
+//     and/or other materials provided with the distribution.
+//
+//  3. Neither the name of the copyright holder nor the names of its contributors
+//     may be used to endorse or promote products derived from this software
+//     without specific prior written permission.
+//
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+//  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+//  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+//  IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+//  INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+//  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+//  DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+//  LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE
+//  OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+//  OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+//===================================================================================
+
+#ifndef SMARTSOFT_INTERFACES_SMARTVIRTUALTIMETIMERMANAGER_H_
+#define SMARTSOFT_INTERFACES_SMARTVIRTUALTIMETIMERMANAGER_H_
+
+// C++11 includes
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <thread>
+#include <condition_variable>
+
+#include "smartTimerManagerBase.h"
+#include "smartIVirtualClock.h"
+
+namespace Smart {
+
+/** Reference implementation of the ITimerManager interface using a simulated clock
+ *
+ *  This timer manager is meant for regression runs and the replay of recorded missions
+ *  faster than real time. Its time does not pass by itself: as soon as all participants
+ *  of the IVirtualClock are idle (i.e. all triggered tasks wait on their triggers again),
+ *  the virtual time jumps to the next due timer, whose upcalls are executed immediately.
+ *  Since the triggered tasks are marked busy from within these upcalls, the virtual time
+ *  cannot advance any further before the tasks have finished their cycles. Thus, the
+ *  expiries and the triggered task cycles occur in the same (deterministic) order in each
+ *  run, independent of the actual execution times.
+ *
+ *  The virtual steady time starts at the epoch of std::chrono::steady_clock, the time passed
+ *  to ITimerHandler::timerExpired() starts at the given start time (e.g. the start time of a
+ *  recorded log file). The upcalls are always dispatched inline (see setDispatchMode()).
+ *
+ *  Typical usage:
+ *  @code
+ *  VirtualTimeTimerManager timer_manager;
+ *  IVirtualClock::setProcessClock(&timer_manager);
+ *  // ... create and start the tasks and their TimedTaskTrigger ...
+ *  timer_manager.run(std::chrono::hours(8));
+ *  @endcode
+ *
+ *  Interactions that are not visible to the clock (e.g. messages in transit to other
+ *  processes or tasks that do not wait on a TaskTriggerObserver) are not waited for.
+ */
+class VirtualTimeTimerManager
+:	public TimerManagerBase
+,	public IVirtualClock
+{
+private:
+	std::condition_variable clock_cond_var;
+	std::atomic<TimingWheel::TimePoint> virtual_now;
+	std::chrono::system_clock::time_point start_time;
+	unsigned int busy_count;
+	bool running;
+	bool stop_requested;
+	std::thread clock_thread;
+
+protected:
+	virtual TimingWheel::TimePoint current_time() const {
+		return virtual_now.load();
+	}
+
+	virtual std::chrono::system_clock::time_point current_system_time() const {
+		return start_time + std::chrono::duration_cast<std::chrono::system_clock::duration>(virtual_now.load().time_since_epoch());
+	}
+
+	virtual void notify_dispatcher(const TimingWheel::TimePoint &) {
+		// the clock re-evaluates the next expiry whenever it is idle
+		clock_cond_var.notify_all();
+	}
+
+public:
+	/** Default constructor
+	 *
+	 *  @param resolution the tick resolution of the internal TimingWheel
+	 *  @param start_time the system time at the start of the virtual time
+	 */
+	VirtualTimeTimerManager(
+			const std::chrono::steady_clock::duration &resolution=std::chrono::milliseconds(1),
+			const std::chrono::system_clock::time_point &start_time=std::chrono::system_clock::now()
+		)
+	:	TimerManagerBase(resolution, TimingWheel::TimePoint())
+	,	virtual_now(TimingWheel::TimePoint())
+	,	start_time(start_time)
+	,	busy_count(0)
+	,	running(false)
+	,	stop_requested(false)
+	{  }
+
+	/** Default destructor
+	 *
+	 *  Stops the virtual time (the remaining timers are cancelled in TimerManagerBase).
+	 *  All TaskTriggerObserver instances using this clock must have been destroyed before.
+	 */
+	virtual ~VirtualTimeTimerManager()
+	{
+		this->stop();
+		if(IVirtualClock::getProcessClock() == this) {
+			IVirtualClock::setProcessClock(0);
+		}
+	}
+
+	/** Runs the virtual time within the calling thread
+	 *
+	 *  The time advances from expiry to expiry until either the given duration has passed
+	 *  (and everything is idle) or stop() is called. Without a duration, run() waits for new
+	 *  timers or stop() when there are no timers left.
+	 *
+	 *  @param duration the maximum (virtual) duration to run
+	 *
+	 *  @return 0 on success or -1 if the virtual time is already running
+	 */
+	int run(const std::chrono::steady_clock::duration &duration=std::chrono::steady_clock::duration::max()) {
+		unsigned long applied_generation = 0;
+		std::unique_lock<std::mutex> lock(timer_mutex);
+		if(running == true) return -1;
+		running = true;
+		const TimingWheel::TimePoint begin = virtual_now.load();
+		const TimingWheel::TimePoint end = (duration < TimingWheel::TimePoint::max() - begin)? begin + duration : TimingWheel::TimePoint::max();
+		while(!stop_requested) {
+			this->apply_dispatch_parameters(applied_generation);
+			if(busy_count > 0) {
+				// wait until all triggered work is done
+				clock_cond_var.wait(lock);
+				continue;
+			}
+			TimingWheel::TimePoint next_expiry;
+			if(!wheel.nextExpiry(next_expiry)) {
+				if(end == TimingWheel::TimePoint::max()) {
+					clock_cond_var.wait(lock);
+					continue;
+				}
+				next_expiry = TimingWheel::TimePoint::max();
+			}
+			if(next_expiry > end) {
+				virtual_now.store(end);
+				break;
+			}
+			if(next_expiry > virtual_now.load()) {
+				virtual_now.store(next_expiry);
+			}
+			this->dispatch_expired(lock);
+		}
+		running = false;
+		clock_cond_var.notify_all();
+		return 0;
+	}
+
+	/** Runs the virtual time within an internal thread (see run())
+	 *
+	 *  @return 0 on success or -1 if the virtual time is already running
+	 */
+	int start(const std::chrono::steady_clock::duration &duration=std::chrono::steady_clock::duration::max()) {
+		std::unique_lock<std::mutex> lock(timer_mutex);
+		if(running == true || clock_thread.joinable()) return -1;
+		stop_requested = false;
+		clock_thread = std::thread(&VirtualTimeTimerManager::run, this, duration);
+		return 0;
+	}
+
+	/// stops the virtual time (and waits for an internal thread to finish)
+	void stop() {
+		{
+			std::unique_lock<std::mutex> lock(timer_mutex);
+			stop_requested = true;
+			clock_cond_var.notify_all();
+		}
+		if(clock_thread.joinable()) clock_thread.join();
+		std::unique_lock<std::mutex> lock(timer_mutex);
+		while(running == true) clock_cond_var.wait(lock);
+		stop_requested = false;
+	}
+
+	/// only TIMER_DISPATCH_INLINE is supported, since asynchronous upcalls would break the determinism
+	virtual int setDispatchMode(const TimerDispatchMode &mode, const unsigned int &workers=2) {
+		if(mode != TIMER_DISPATCH_INLINE) return -1;
+		return TimerManagerBase::setDispatchMode(mode, workers);
+	}
+
+	virtual std::chrono::steady_clock::time_point now() {
+		return virtual_now.load();
+	}
+
+	virtual void enterBusy() {
+		std::unique_lock<std::mutex> lock(timer_mutex);
+		busy_count++;
+	}
+
+	virtual void leaveBusy() {
+		std::unique_lock<std::mutex> lock(timer_mutex);
+		if(busy_count > 0) busy_count--;
+		if(busy_count == 0) clock_cond_var.notify_all();
+	}
+
+	virtual ITimerManager* getTimerManager() {
+		return this;
+	}
+};
+
+} /* namespace Smart */
+
+#endif /* SMARTSOFT_INTERFACES_SMARTVIRTUALTIMETIMERMANAGER_H_ */
@@ -0,0 +1,156 @@
+//===================================================================================
+//
+//  Copyright (C) 2017 Alex Lotz, Dennis Stampfer, Matthias Lutz, Christian Schlegel
+//
+//        lotz@hs-ulm.de
+//        stampfer@hs-ulm.de
+//        lutz@hs-ulm.de
+//        schlegel@hs-ulm.de
+//
+//        Servicerobotik Ulm
+//        Christian Schlegel
+//        Ulm University of Applied Sciences
+//        Prittwitzstr. 10
+//        89075 Ulm
+//        Germany
+//
+//  This file is part of the SmartSoft Component-Developer C++ API.
+//
+//  Redistribution and use in source and binary forms, with or without modification,
+//  are permitted provided that the following conditions are met:
+//
+//  1. Redistributions of source code must retain the above copyright notice,
+//     this list of conditions and the following disclaimer.
+//
+//  2. Redistributions in binary form must reproduce the above copyright notice,
+//     this list of conditions and the following disclaimer in the documentation
+//     and/or other materials provided with the distribution.
+//
+//  3. Neither the name of the copyright holder nor the names of its contributors
+//     may be used to endorse or promote products derived from this software
+//     without specific prior written permission.
+//
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+//  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+//  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+//  IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+//  INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+//  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+//  DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+//  LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE
+//  OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+//  OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+//===================================================================================
+
+// Publishes an input with 1 kHz while 4 reader threads continuously copy the latest value
+// (similar to an InputTaskTrigger with 4 attached tasks) and compares the write latency and
+// the reader throughput of the LatestValueBuffer with a value that is protected by a mutex.
+
+#include <iostream>
+#include <vector>
+#include <algorithm>
+
+// C++11 includes
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <thread>
+
+#include "smartLatestValueBuffer_T.h"
+
+namespace {
+
+const std::size_t NUM_READERS = 4;
+const std::size_t NUM_UPDATES = 1000;
+const std::chrono::milliseconds UPDATE_PERIOD(1);
+
+typedef std::vector<double> Input;
+
+class MutexBuffer {
+private:
+	mutable std::mutex mutex;
+	Input value;
+	uint64_t sequence;
+
+public:
+	MutexBuffer()
+	:	sequence(0)
+	{  }
+
+	void write(const Input &input) {
+		std::unique_lock<std::mutex> lock(mutex);
+		value = input;
+		++sequence;
+	}
+
+	uint64_t read(Input &input) const {
+		std::unique_lock<std::mutex> lock(mutex);
+		input = value;
+		return sequence;
+	}
+};
+
+template <class Buffer>
+void benchmark(const char *name, Buffer &buffer, const std::size_t &input_size) {
+	std::atomic<bool> stopped(false);
+	std::atomic<unsigned long> reads(0);
+	std::atomic<unsigned long> inconsistent_reads(0);
+
+	std::vector<std::thread> readers;
+	for(std::size_t i=0; i<NUM_READERS; ++i) {
+		readers.push_back(std::thread([&]() {
+			Input input;
+			while(!stopped) {
+				if(buffer.read(input) == 0) continue;
+				if(input.front() != input.back()) inconsistent_reads++;
+				reads++;
+			}
+		}));
+	}
+
+	std::vector<double> latencies;
+	latencies.reserve(NUM_UPDATES);
+	Input input(input_size);
+	const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	std::chrono::steady_clock::time_point next_update = start;
+	for(std::size_t i=1; i<=NUM_UPDATES; ++i) {
+		std::fill(input.begin(), input.end(), static_cast<double>(i));
+		next_update += UPDATE_PERIOD;
+		std::this_thread::sleep_until(next_update);
+		const std::chrono::steady_clock::time_point write_start = std::chrono::steady_clock::now();
+		buffer.write(input);
+		latencies.push_back(std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - write_start).count());
+	}
+	const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	stopped = true;
+	for(std::size_t i=0; i<readers.size(); ++i) {
+		readers[i].join();
+	}
+
+	std::sort(latencies.begin(), latencies.end());
+	std::cout << name << "write p50 " << latencies[latencies.size()/2]
+		<< " us, p99 " << latencies[latencies.size()*99/100]
+		<< " us, max " << latencies.back()
+		<< " us, reads/s " << static_cast<unsigned long>(reads / seconds)
+		<< ", inconsistent reads " << inconsistent_reads << std::endl;
+}
+
+} // namespace
+
+int main() {
+	const std::size_t input_sizes[] = { 100, 10000 };
+	for(std::size_t i=0; i<sizeof(input_sizes)/sizeof(input_sizes[0]); ++i) {
+		std::cout << "input of " << input_sizes[i] << " doubles, " << NUM_UPDATES << " updates with 1 kHz, "
+			<< NUM_READERS << " readers" << std::endl;
+		{
+			MutexBuffer buffer;
+			benchmark("  mutex:             ", buffer, input_sizes[i]);
+		}
+		{
+			Smart::LatestValueBuffer<Input> buffer;
+			benchmark("  LatestValueBuffer: ", buffer, input_sizes[i]);
+		}
+	}
+	return 0;
+}
@@ -0,0 +1,144 @@
+//===================================================================================
+//
+//  Copyright (C) 2017 Alex Lotz, Dennis Stampfer, Matthias Lutz, Christian Schlegel
+//
+//        lotz@hs-ulm.de
+//        stampfer@hs-ulm.de
+//        lutz@hs-ulm.de
+//        schlegel@hs-ulm.de
+//
+//        Servicerobotik Ulm
+//        Christian Schlegel
+//        Ulm University of Applied Sciences
+//        Prittwitzstr. 10
+//        89075 Ulm
+//        Germany
+//
+//  This file is part of the SmartSoft Component-Developer C++ API.
+//
+//  Redistribution and use in source and binary forms, with or without modification,
+//  are permitted provided that the following conditions are met:
+//
+//  1. Redistributions of source code must retain the above copyright notice,
+//     this list of conditions and the following disclaimer.
+//
+//  2. Redistributions in binary form must reproduce the above copyright notice,
+//     this list of conditions and the following disclaimer in the documentation
+//     and/or other materials provided with the distribution.
+//
+//  3. Neither the name of the copyright holder nor the names of its contributors
+//     may be used to endorse or promote products derived from this software
+//     without specific prior written permission.
+//
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+//  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+//  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+//  IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+//  INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+//  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+//  DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+//  LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE
+//  OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+//  OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+//===================================================================================
+
+// Keeps 1000 pending queries and replaces each of them 2000 times (find, erase and insert
+// of a new entry) with the SlotMap and compares the cost per replacement with the
+// std::map and std::unordered_map keyed by a query id.
+
+#include <iostream>
+#include <vector>
+#include <map>
+#include <unordered_map>
+
+// C++11 includes
+#include <chrono>
+
+#include "smartSlotMap_T.h"
+
+namespace {
+
+const std::size_t NUM_PENDING = 1000;
+const std::size_t NUM_ROUNDS = 2000;
+
+// similar to the per-query state of the query patterns (the answer keeps its heap memory)
+struct PendingQuery {
+	int status;
+	std::vector<double> answer;
+
+	PendingQuery()
+	:	status(0)
+	{  }
+};
+
+double nanosecondsPerOperation(const std::chrono::steady_clock::duration &elapsed, const std::size_t &operations) {
+	return std::chrono::duration<double, std::nano>(elapsed).count() / operations;
+}
+
+// replaces each pending query NUM_ROUNDS times in a map keyed by a continuously increasing id
+template <class MapType>
+void benchmarkIdMap(const char *name, MapType &queries) {
+	std::vector<unsigned long> ids(NUM_PENDING);
+	unsigned long next_id = 0;
+	for(std::size_t i=0; i<NUM_PENDING; ++i) {
+		ids[i] = next_id;
+		queries[next_id++] = PendingQuery();
+	}
+
+	long checksum = 0;
+	const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	for(std::size_t round=0; round<NUM_ROUNDS; ++round) {
+		for(std::size_t i=0; i<NUM_PENDING; ++i) {
+			typename MapType::iterator it = queries.find(ids[i]);
+			checksum += it->second.status;
+			queries.erase(it);
+			ids[i] = next_id;
+			queries[next_id++].status = static_cast<int>(i);
+		}
+	}
+	const std::chrono::steady_clock::time_point finished = std::chrono::steady_clock::now();
+
+	std::cout << name << nanosecondsPerOperation(finished - start, NUM_PENDING*NUM_ROUNDS)
+		<< " ns/op (checksum " << checksum << ")" << std::endl;
+}
+
+} // namespace
+
+int main() {
+	{
+		Smart::SlotMap<PendingQuery> queries(NUM_PENDING);
+		std::vector<Smart::SlotMapId> ids(NUM_PENDING);
+		for(std::size_t i=0; i<NUM_PENDING; ++i) {
+			ids[i] = queries.insert(PendingQuery());
+		}
+
+		long checksum = 0;
+		const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+		for(std::size_t round=0; round<NUM_ROUNDS; ++round) {
+			for(std::size_t i=0; i<NUM_PENDING; ++i) {
+				PendingQuery *query = queries.find(ids[i]);
+				checksum += query->status;
+				queries.erase(ids[i]);
+				query = queries.insertSlot(ids[i]);
+				query->status = static_cast<int>(i);
+			}
+		}
+		const std::chrono::steady_clock::time_point finished = std::chrono::steady_clock::now();
+
+		std::cout << "SlotMap:            " << nanosecondsPerOperation(finished - start, NUM_PENDING*NUM_ROUNDS)
+			<< " ns/op (checksum " << checksum << ")" << std::endl;
+	}
+
+	{
+		std::map<unsigned long, PendingQuery> queries;
+		benchmarkIdMap("std::map:           ", queries);
+	}
+
+	{
+		std::unordered_map<unsigned long, PendingQuery> queries;
+		queries.reserve(NUM_PENDING);
+		benchmarkIdMap("std::unordered_map: ", queries);
+	}
+	return 0;
+}
@@ -0,0 +1,124 @@
+//===================================================================================
+//
+//  Copyright (C) 2017 Alex Lotz, Dennis Stampfer, Matthias Lutz, Christian Schlegel
+//
+//        lotz@hs-ulm.de
+//        stampfer@hs-ulm.de
+//        lutz@hs-ulm.de
+//        schlegel@hs-ulm.de
+//
+//        Servicerobotik Ulm
+//        Christian Schlegel
+//        Ulm University of Applied Sciences
+//        Prittwitzstr. 10
+//        89075 Ulm
+//        Germany
+//
+//  This file is part of the SmartSoft Component-Developer C++ API.
+//
+//  Redistribution and use in source and binary forms, with or without modification,
+//  are permitted provided that the following conditions are met:
+//
+//  1. Redistributions of source code must retain the above copyright notice,
+//     this list of conditions and the following disclaimer.
+//
+//  2. Redistributions in binary form must reproduce the above copyright notice,
+//     this list of conditions and the following disclaimer in the documentation
+//     and/or other materials provided with the distribution.
+//
+//  3. Neither the name of the copyright holder nor the names of its contributors
+//     may be used to endorse or promote products derived from this software
+//     without specific prior written permission.
+//
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+//  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+//  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+//  IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+//  INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+//  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+//  DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+//  LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE
+//  OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+//  OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+//===================================================================================
+
+// Schedules and cancels 1M one-shot timers with the TimingWheelTimerManager and
+// compares the cost per operation with a std::multimap keyed by the deadline.
+
+#include <iostream>
+#include <vector>
+#include <map>
+#include <atomic>
+
+// C++11 includes
+#include <chrono>
+
+#include "smartTimingWheelTimerManager.h"
+
+namespace {
+
+const std::size_t NUM_TIMERS = 1000000;
+
+class CountingHandler : public Smart::ITimerHandler {
+public:
+	std::atomic<unsigned long> expired;
+
+	CountingHandler()
+	:	expired(0)
+	{  }
+
+	virtual void timerExpired(const std::chrono::system_clock::time_point &) {
+		expired++;
+	}
+	virtual void timerCancelled() {  }
+	virtual void timerDeleted() {  }
+};
+
+double nanosecondsPerOperation(const std::chrono::steady_clock::duration &elapsed, const std::size_t &operations) {
+	return std::chrono::duration<double, std::nano>(elapsed).count() / operations;
+}
+
+} // namespace
+
+int main() {
+	std::vector<long> timer_ids(NUM_TIMERS);
+	{
+		CountingHandler handler;
+		Smart::TimingWheelTimerManager manager;
+
+		// the deadlines are spread over 100 s, none of them expires during the benchmark
+		const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+		for(std::size_t i=0; i<NUM_TIMERS; ++i) {
+			timer_ids[i] = manager.scheduleTimer(&handler, std::chrono::seconds(1000) + std::chrono::microseconds(100*i));
+		}
+		const std::chrono::steady_clock::time_point scheduled = std::chrono::steady_clock::now();
+		for(std::size_t i=0; i<NUM_TIMERS; ++i) {
+			manager.cancelTimer(timer_ids[i]);
+		}
+		const std::chrono::steady_clock::time_point cancelled = std::chrono::steady_clock::now();
+
+		std::cout << "TimingWheelTimerManager: scheduleTimer " << nanosecondsPerOperation(scheduled - start, NUM_TIMERS)
+			<< " ns/op, cancelTimer " << nanosecondsPerOperation(cancelled - scheduled, NUM_TIMERS) << " ns/op" << std::endl;
+	}
+
+	{
+		typedef std::multimap<std::chrono::steady_clock::time_point, std::size_t> TimerMap;
+		TimerMap timers;
+		std::vector<TimerMap::iterator> timer_iterators(NUM_TIMERS);
+
+		const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+		for(std::size_t i=0; i<NUM_TIMERS; ++i) {
+			timer_iterators[i] = timers.insert(std::make_pair(std::chrono::steady_clock::now() + std::chrono::seconds(1000) + std::chrono::microseconds(100*i), i));
+		}
+		const std::chrono::steady_clock::time_point scheduled = std::chrono::steady_clock::now();
+		for(std::size_t i=0; i<NUM_TIMERS; ++i) {
+			timers.erase(timer_iterators[i]);
+		}
+		const std::chrono::steady_clock::time_point cancelled = std::chrono::steady_clock::now();
+
+		std::cout << "std::multimap:            insert " << nanosecondsPerOperation(scheduled - start, NUM_TIMERS)
+			<< " ns/op, erase " << nanosecondsPerOperation(cancelled - scheduled, NUM_TIMERS) << " ns/op" << std::endl;
+	}
+	return 0;
+}